@@ -9,21 +9,35 @@ size_t WriteCallback(void* contents, size_t size, size_t nmemb,
 }
 
 
-std::string getResponse(const std::string& userInput) {
-    CURL* curl;
-    CURLcode res;
-    std::string read_buffer;
+namespace {
+const char* const kDefaultEndpoint = "https://api.groq.com/openai/v1/chat/completions";
 
-    curl = curl_easy_init();
+// Ненулевой ответ прерывает передачу с CURLE_ABORTED_BY_CALLBACK
+int ProgressCallback(void* clientp, curl_off_t, curl_off_t, curl_off_t, curl_off_t) {
+    const auto* cancel = static_cast<const std::atomic<bool>*>(clientp);
+    return cancel != nullptr && cancel->load() ? 1 : 0;
+}
 
+size_t BufferCallback(char* contents, size_t size, size_t nmemb, void* userdata) {
+    return WriteCallback(contents, size, nmemb, static_cast<std::string*>(userdata));
+}
 
+std::string RequestBody(const std::string& userInput, bool stream) {
+    return "{\"model\": \"llama-3.3-70b-versatile\", "
+           + std::string(stream ? "\"stream\": true, " : "")
+           + "\"messages\": [{\"role\": \"user\", \"content\": \"" + userInput + "\"}]}";
+}
+
+// Общая часть запросов: заголовки, таймауты, отмена и приемник ответа
+CURLcode Perform(const std::string& json_data, const RequestOptions& options,
+                 curl_write_callback write, void* write_data) {
+    CURL* curl = curl_easy_init();
     if (curl == nullptr) {
-        std::cerr << "Ошибка инициализации cURL." << std::endl;
-        return "Ошибка.";
+        throw std::runtime_error("Ошибка инициализации cURL.");
     }
 
-    curl_easy_setopt(curl, CURLOPT_URL,
-                     "https://api.groq.com/openai/v1/chat/completions");
+    const std::string endpoint = apiEndpoint();
+    curl_easy_setopt(curl, CURLOPT_URL, endpoint.c_str());
 
     struct curl_slist* headers = nullptr;
     headers = curl_slist_append(headers,
@@ -34,33 +48,164 @@ std::string getResponse(const std::string& userInput) {
     headers = curl_slist_append(headers, "Content-Type: application/json");
     curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
 
-    std::string json_data =
-        "{\"model\": \"llama-3.3-70b-versatile\", \"messages\": [{\"role\": "
-        "\"user\", \"content\": \"" +
-        userInput + "\"}]}";
     curl_easy_setopt(curl, CURLOPT_POST, 1L);
     curl_easy_setopt(curl, CURLOPT_POSTFIELDS, json_data.c_str());
 
+    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, write);
+    curl_easy_setopt(curl, CURLOPT_WRITEDATA, write_data);
+
+    // Запрос идет из рабочего потока: без сигналов, с таймаутами и отменой
+    curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1L);
+    curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT, options.connect_timeout_sec);
+    curl_easy_setopt(curl, CURLOPT_TIMEOUT, options.total_timeout_sec);
+    curl_easy_setopt(curl, CURLOPT_XFERINFOFUNCTION, ProgressCallback);
+    curl_easy_setopt(curl, CURLOPT_XFERINFODATA, const_cast<std::atomic<bool>*>(options.cancel));
+    curl_easy_setopt(curl, CURLOPT_NOPROGRESS, 0L);
+    const CURLcode res = curl_easy_perform(curl);
+
+    curl_slist_free_all(headers);
+    curl_easy_cleanup(curl);
+    return res;
+}
+}
+
 
-    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, WriteCallback);
-    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &read_buffer);
-    res = curl_easy_perform(curl);
+std::string apiEndpoint() {
+    const char* endpoint = std::getenv("KEYBOARD_TRAINER_AI_ENDPOINT");
+    return endpoint != nullptr && *endpoint != '\0' ? endpoint : kDefaultEndpoint;
+}
+
+
+void SseStreamState::feedLine(std::string_view line) {
+    if (!line.empty() && line.back() == '\r') {
+        line.remove_suffix(1);
+    }
+    if (line.substr(0, 5) != "data:") {
+        return;
+    }
+    line.remove_prefix(5);
+    if (!line.empty() && line.front() == ' ') {
+        line.remove_prefix(1);
+    }
+    sawEvent = true;
+    if (done || line == "[DONE]") {
+        done = true;
+        return;
+    }
 
+    // Служебные события (например, usage) приходят с пустым choices
+    const auto event = nlohmann::json::parse(line);
+    const auto& choices = event.at("choices");
+    if (choices.empty()) {
+        return;
+    }
+    const auto delta_it = choices.at(0).find("delta");
+    if (delta_it == choices.at(0).end()) {
+        return;
+    }
+    const auto content_it = delta_it->find("content");
+    if (content_it != delta_it->end() && content_it->is_string()) {
+        const std::string text = content_it->get<std::string>();
+        if (!text.empty()) {
+            content += text;
+            if (onDelta) {
+                onDelta(text);
+            }
+        }
+    }
+}
+
+
+size_t StreamWriteCallback(char* contents, size_t size, size_t nmemb, void* userdata) {
+    auto* state = static_cast<SseStreamState*>(userdata);
+    const size_t total_size = size * nmemb;
+    state->pending.append(contents, total_size);
+    if (!state->sawEvent) {
+        state->raw.append(contents, total_size);
+    }
 
+    // Исключение не должно пройти через C-код curl: запоминаем его и прерываем передачу
+    try {
+        size_t start = 0;
+        for (size_t end = state->pending.find('\n'); end != std::string::npos;
+             end = state->pending.find('\n', start)) {
+            state->feedLine(std::string_view(state->pending).substr(start, end - start));
+            start = end + 1;
+        }
+        state->pending.erase(0, start);
+    } catch (...) {
+        state->error = std::current_exception();
+        return 0;
+    }
+    return total_size;
+}
+
+
+std::string FinishStream(SseStreamState& state) {
+    if (state.error) {
+        std::rethrow_exception(state.error);
+    }
+
+    // Последняя строка могла прийти без перевода строки
+    if (!state.pending.empty() && state.sawEvent) {
+        state.feedLine(state.pending);
+        state.pending.clear();
+    }
+    if (state.sawEvent) {
+        // Сервер закрыл соединение до [DONE]: текст неполный
+        if (!state.done) {
+            throw std::runtime_error("Поток ответа оборвался.");
+        }
+        return state.content;
+    }
+
+    // Событий не было: обычный ответ или сообщение об ошибке целиком
+    auto json_response = nlohmann::json::parse(state.raw);
+    std::string response_content =
+        json_response["choices"][0]["message"]["content"];
+    if (state.onDelta) {
+        state.onDelta(response_content);
+    }
+    return response_content;
+}
+
+
+std::string getResponse(const std::string& userInput) {
+    try {
+        return getResponse(userInput, RequestOptions());
+    } catch (const std::runtime_error& error) {
+        std::cerr << "curl_easy_perform() failed: " << error.what() << std::endl;
+        return "Ошибка.";
+    }
+}
+
+
+std::string getResponse(const std::string& userInput, const RequestOptions& options) {
+    std::string read_buffer;
+    const CURLcode res = Perform(RequestBody(userInput, false), options,
+                                 BufferCallback, &read_buffer);
     if (res != CURLE_OK) {
-        std::cerr << "curl_easy_perform() failed: " << curl_easy_strerror(res)
-                  << std::endl;
-        read_buffer = "Ошибка.";
-    } else {
-        auto json_response = nlohmann::json::parse(read_buffer);
-        std::string response_content =
-            json_response["choices"][0]["message"]["content"];
-        read_buffer = response_content;
+        throw std::runtime_error(curl_easy_strerror(res));
     }
 
+    auto json_response = nlohmann::json::parse(read_buffer);
+    std::string response_content =
+        json_response["choices"][0]["message"]["content"];
+    return response_content;
+}
 
-    curl_slist_free_all(headers);
-    curl_easy_cleanup(curl);
 
-    return read_buffer;
+std::string getStreamingResponse(const std::string& userInput, const RequestOptions& options,
+                                 const StreamCallback& onDelta) {
+    SseStreamState state;
+    state.onDelta = onDelta;
+    const CURLcode res = Perform(RequestBody(userInput, true), options,
+                                 StreamWriteCallback, &state);
+    if (state.error) {
+        std::rethrow_exception(state.error);
+    }
+    if (res != CURLE_OK) {
+        throw std::runtime_error(curl_easy_strerror(res));
+    }
+    return FinishStream(state);
 }
@@ -6,5 +6,49 @@
 #include <sstream>
 size_t WriteCallback(void* contents, size_t size, size_t nmemb,
                      std::string* out);
+
+// Параметры запроса из фонового потока: таймауты и флаг отмены,
+// который проверяется curl во время передачи
+struct RequestOptions {
+    long connect_timeout_sec = 10;
+    long total_timeout_sec = 60;
+    const std::atomic<bool>* cancel = nullptr;
+};
+
+// Очередной фрагмент ответа в потоковом режиме; вызывается из потока запроса
+using StreamCallback = std::function<void(const std::string& delta)>;
+
+// Адрес chat/completions; переопределяется KEYBOARD_TRAINER_AI_ENDPOINT (например, для mock-сервера)
+std::string apiEndpoint();
+
+// Разбор server-sent events формата chat/completions: строки "data: {...}",
+// события разделены пустой строкой, поток заканчивается "data: [DONE]".
+// Тело приходит кусками произвольной длины, поэтому неполная строка ждет продолжения
+struct SseStreamState {
+    StreamCallback onDelta;
+    std::string pending;
+    std::string raw;    // тело целиком, пока не встретилось ни одного события
+    std::string content;
+    bool sawEvent = false;
+    bool done = false;
+    // Ошибка разбора внутри приемника curl; передача при этом прерывается
+    std::exception_ptr error;
+
+    void feedLine(std::string_view line);
+};
+
+// Приемник curl для потокового ответа; userdata — SseStreamState*
+size_t StreamWriteCallback(char* contents, size_t size, size_t nmemb, void* userdata);
+// Разбирает остаток после конца передачи и возвращает весь текст. Если событий
+// не было, тело разбирается как обычный ответ chat/completions; поток без [DONE] —
+// std::runtime_error
+std::string FinishStream(SseStreamState& state);
+
 std::string getResponse(const std::string& userInput);
+// Ошибки сети и отмена — std::runtime_error, разбор ответа — исключения nlohmann::json
+std::string getResponse(const std::string& userInput, const RequestOptions& options);
+// То же с "stream": true: фрагменты из server-sent events отдаются onDelta по мере прихода,
+// возвращается весь текст. Сервер без поддержки потока может ответить обычным JSON
+std::string getStreamingResponse(const std::string& userInput, const RequestOptions& options,
+                                 const StreamCallback& onDelta);
 #endif
@@ -0,0 +1,125 @@
+#include "aiprefetchqueue.h"
+#include "aitextgenerator.h"
+#include <QFutureWatcher>
+#include <QTimer>
+#include <QtConcurrent/QtConcurrentRun>
+
+AiPrefetchQueue::AiPrefetchQueue(RequestBuilder builder, QObject *parent)
+    : QObject(parent), builder_(std::move(builder)), cancel_(std::make_shared<std::atomic<bool>>(false)) {}
+
+AiPrefetchQueue::~AiPrefetchQueue() {
+    // Рабочие потоки прервут передачу сами; наблюдатели удаляются вместе с очередью
+    cancel_->store(true);
+}
+
+void AiPrefetchQueue::setDepth(int depth) {
+    depth_ = qMax(0, depth);
+    lowWatermark_ = qMin(lowWatermark_, depth_);
+    refill();
+}
+
+void AiPrefetchQueue::setLowWatermark(int watermark) {
+    lowWatermark_ = qBound(0, watermark, depth_);
+    refill();
+}
+
+void AiPrefetchQueue::setConcurrency(int concurrency) {
+    concurrency_ = qMax(1, concurrency);
+    refill();
+}
+
+void AiPrefetchQueue::setLanguage(const QString &language) {
+    if (language == language_) {
+        return;
+    }
+    language_ = language;
+    filling_ = false;
+    failures_ = 0;
+    refill();
+}
+
+void AiPrefetchQueue::seed(const QString &language, const QStringList &texts) {
+    QQueue<QString> &queue = queues_[language];
+    for (const QString &text : texts) {
+        if (queue.size() >= depth_) {
+            break;
+        }
+        if (!queue.contains(text)) {
+            queue.enqueue(text);
+        }
+    }
+    refill();
+    emit changed();
+}
+
+bool AiPrefetchQueue::take(const QString &language, QString &text) {
+    auto it = queues_.find(language);
+    const bool hit = it != queues_.end() && !it->isEmpty();
+    if (hit) {
+        text = it->dequeue();
+        ++hits_;
+    } else {
+        ++misses_;
+    }
+    refill();
+    emit changed();
+    return hit;
+}
+
+void AiPrefetchQueue::refill() {
+    if (language_.isEmpty() || depth_ == 0 || retryScheduled_) {
+        return;
+    }
+
+    const int ready = queues_.value(language_).size();
+    if (ready < lowWatermark_ || (ready == 0 && lowWatermark_ == 0)) {
+        filling_ = true;
+    }
+    if (!filling_) {
+        return;
+    }
+
+    // Запросы, уже идущие для другого языка, тоже занимают слоты
+    while (inFlight_ < concurrency_ && ready + inFlight_ < depth_) {
+        const QString language = language_;
+        auto *watcher = new QFutureWatcher<AiResult>(this);
+        connect(watcher, &QFutureWatcher<AiResult>::finished, this, [this, watcher, language]() {
+            watcher->deleteLater();
+            const AiResult result = watcher->result();
+            --inFlight_;
+            if (!result.canceled) {
+                onFetched(language, result.text, result.error);
+            }
+        });
+        watcher->setFuture(QtConcurrent::run(&AiTextGenerator::fetch, builder_(language).toStdString(), cancel_));
+        ++inFlight_;
+    }
+}
+
+void AiPrefetchQueue::onFetched(const QString &language, const QString &text, const QString &error) {
+    if (!error.isEmpty() || text.trimmed().isEmpty()) {
+        // Без сети не долбим сервер: пауза удваивается с каждой неудачей подряд
+        const int delay = kAiPrefetchRetryMs << qMin(failures_, kAiPrefetchMaxBackoffShift);
+        ++failures_;
+        if (!retryScheduled_) {
+            retryScheduled_ = true;
+            QTimer::singleShot(delay, this, [this]() {
+                retryScheduled_ = false;
+                refill();
+            });
+        }
+        return;
+    }
+
+    failures_ = 0;
+    QQueue<QString> &queue = queues_[language];
+    if (queue.size() < depth_) {
+        queue.enqueue(text);
+        emit fetched(language, text);
+    }
+    if (language == language_ && queue.size() >= depth_) {
+        filling_ = false;
+    }
+    refill();
+    emit changed();
+}
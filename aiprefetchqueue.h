@@ -0,0 +1,80 @@
+#ifndef AIPREFETCHQUEUE_H
+#define AIPREFETCHQUEUE_H
+
+#include <QHash>
+#include <QObject>
+#include <QQueue>
+#include <QString>
+#include <QStringList>
+#include <atomic>
+#include <functional>
+#include <memory>
+
+constexpr int kAiPrefetchDepth = 3;
+constexpr int kAiPrefetchLowWatermark = 2;
+constexpr int kAiPrefetchConcurrency = 1;
+constexpr int kAiPrefetchRetryMs = 2000;
+constexpr int kAiPrefetchMaxBackoffShift = 5;   // не реже раза в ~минуту
+
+// Очередь заранее сгенерированных текстов AI по языкам. После выбора языка
+// в фоне держится до depth готовых текстов; когда их остается меньше
+// lowWatermark, очередь снова дополняется до depth, не больше concurrency
+// запросов одновременно. Ошибки сети не сбрасывают очередь — повтор идет
+// с нарастающей паузой.
+class AiPrefetchQueue : public QObject {
+    Q_OBJECT
+
+public:
+    // Текст запроса к модели для языка
+    using RequestBuilder = std::function<QString(const QString &language)>;
+
+    explicit AiPrefetchQueue(RequestBuilder builder, QObject *parent = nullptr);
+    ~AiPrefetchQueue() override;
+
+    void setDepth(int depth);
+    void setLowWatermark(int watermark);
+    void setConcurrency(int concurrency);
+    int depth() const { return depth_; }
+
+    // Язык, для которого идет предзагрузка; тексты других языков остаются в очередях
+    void setLanguage(const QString &language);
+    // Готовые тексты не из сети (например, из кэша ответов); очередь дополняется ими до depth
+    void seed(const QString &language, const QStringList &texts);
+
+    // Готовый текст для языка; false — очередь пуста (промах)
+    bool take(const QString &language, QString &text);
+
+    int readyCount(const QString &language) const { return queues_.value(language).size(); }
+    int inFlight() const { return inFlight_; }
+    quint64 hits() const { return hits_; }
+    quint64 misses() const { return misses_; }
+
+signals:
+    // Новый текст попал в очередь
+    void fetched(const QString &language, const QString &text);
+    void changed();
+
+private:
+    void refill();
+    void onFetched(const QString &language, const QString &text, const QString &error);
+
+    RequestBuilder builder_;
+    int depth_ = kAiPrefetchDepth;
+    int lowWatermark_ = kAiPrefetchLowWatermark;
+    int concurrency_ = kAiPrefetchConcurrency;
+
+    QString language_;
+    QHash<QString, QQueue<QString>> queues_;
+    // Очередь активного языка дополняется до depth, начиная с порога lowWatermark
+    bool filling_ = false;
+    int inFlight_ = 0;
+    int failures_ = 0;
+    bool retryScheduled_ = false;
+    quint64 hits_ = 0;
+    quint64 misses_ = 0;
+
+    // Общий флаг отмены всех фоновых запросов при уничтожении очереди
+    std::shared_ptr<std::atomic<bool>> cancel_;
+};
+
+#endif // AIPREFETCHQUEUE_H
@@ -0,0 +1,93 @@
+#include "aitextgenerator.h"
+#include "AI json-request/api.h"
+#include <QPointer>
+#include <QtConcurrent/QtConcurrentRun>
+
+AiTextGenerator::AiTextGenerator(QObject *parent) : QObject(parent) {}
+
+AiTextGenerator::~AiTextGenerator() {
+    // Рабочий поток увидит флаг и завершится сам; его результат уже никому не нужен
+    cancel();
+}
+
+void AiTextGenerator::generate(const QString &request) {
+    cancel();
+
+    auto flag = std::make_shared<std::atomic<bool>>(false);
+    cancel_ = flag;
+
+    auto *watcher = new QFutureWatcher<AiResult>(this);
+    connect(watcher, &QFutureWatcher<AiResult>::finished, this, [this, watcher, flag]() {
+        watcher->deleteLater();
+        const AiResult result = watcher->result();
+        // Ответ отмененного или уже замененного запроса не доставляется
+        if (flag != cancel_ || flag->load() || result.canceled) {
+            return;
+        }
+        cancel_.reset();
+        if (result.error.isEmpty()) {
+            emit finished(result.text);
+        } else {
+            emit failed(result.error);
+        }
+    });
+    // Фрагменты пересылаются в поток UI через получателя, которого держит и рабочий поток:
+    // генератор может быть уничтожен между проверкой флага и отправкой. Жив ли он,
+    // проверяется уже в потоке UI; фрагменты отброшенного запроса теряются там же
+    std::shared_ptr<QObject> relay(new QObject, [](QObject *relay) { relay->deleteLater(); });
+    const QPointer<AiTextGenerator> self(this);
+    auto onDelta = [relay, self, flag](const std::string &delta) {
+        if (flag->load()) {
+            return;
+        }
+        QMetaObject::invokeMethod(relay.get(), [self, flag, text = QString::fromStdString(delta)]() {
+            if (self && flag == self->cancel_ && !flag->load()) {
+                emit self->partial(text);
+            }
+        }, Qt::QueuedConnection);
+    };
+    watcher->setFuture(QtConcurrent::run(&AiTextGenerator::fetchStreaming, request.toStdString(), flag, onDelta));
+    emit started();
+}
+
+void AiTextGenerator::cancel() {
+    if (cancel_) {
+        cancel_->store(true);
+        cancel_.reset();
+    }
+}
+
+namespace {
+template <typename Request>
+AiResult RunRequest(const std::atomic<bool> &cancel, Request request) {
+    AiResult result;
+    try {
+        result.text = QString::fromStdString(request());
+    } catch (const nlohmann::json::exception&) {
+        result.error = "Ошибка обработки JSON-ответа. Попробуйте включить VPN.";
+    } catch (const std::runtime_error &error) {
+        result.error = QString("Не удалось получить текст: %1").arg(QString::fromUtf8(error.what()));
+    }
+    result.canceled = cancel.load();
+    return result;
+}
+
+RequestOptions AiRequestOptions(const std::atomic<bool> *cancel) {
+    RequestOptions options;
+    options.connect_timeout_sec = kAiConnectTimeoutSec;
+    options.total_timeout_sec = kAiTotalTimeoutSec;
+    options.cancel = cancel;
+    return options;
+}
+}
+
+AiResult AiTextGenerator::fetch(const std::string &request, std::shared_ptr<std::atomic<bool>> cancel) {
+    return RunRequest(*cancel, [&]() { return getResponse(request, AiRequestOptions(cancel.get())); });
+}
+
+AiResult AiTextGenerator::fetchStreaming(const std::string &request, std::shared_ptr<std::atomic<bool>> cancel,
+                                         std::function<void(const std::string &)> onDelta) {
+    return RunRequest(*cancel, [&]() {
+        return getStreamingResponse(request, AiRequestOptions(cancel.get()), onDelta);
+    });
+}
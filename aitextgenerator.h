@@ -0,0 +1,53 @@
+#ifndef AITEXTGENERATOR_H
+#define AITEXTGENERATOR_H
+
+#include <QFutureWatcher>
+#include <QObject>
+#include <QString>
+#include <atomic>
+#include <functional>
+#include <memory>
+
+constexpr long kAiConnectTimeoutSec = 10;
+constexpr long kAiTotalTimeoutSec = 60;
+
+struct AiResult {
+    QString text;
+    QString error;
+    bool canceled = false;
+};
+
+// Запросы к LLM в рабочем потоке. Ответ запрашивается потоком (SSE): фрагменты
+// приходят сигналом partial по мере генерации, весь текст — сигналом finished.
+// Сигналы доставляются в потоке UI;
+// новый запрос или cancel() прерывают текущий — curl проверяет флаг отмены
+// во время передачи, а опоздавший ответ отброшенного запроса не доставляется.
+class AiTextGenerator : public QObject {
+    Q_OBJECT
+
+public:
+    explicit AiTextGenerator(QObject *parent = nullptr);
+    ~AiTextGenerator() override;
+
+    void generate(const QString &request);
+    void cancel();
+    bool isBusy() const { return cancel_ != nullptr; }
+
+    // Блокирующий запрос с таймаутами; вызывается только из рабочего потока
+    static AiResult fetch(const std::string &request, std::shared_ptr<std::atomic<bool>> cancel);
+    // То же в потоковом режиме; onDelta вызывается в рабочем потоке
+    static AiResult fetchStreaming(const std::string &request, std::shared_ptr<std::atomic<bool>> cancel,
+                                   std::function<void(const std::string &)> onDelta);
+
+signals:
+    void started();
+    void partial(const QString &delta);
+    void finished(const QString &text);
+    void failed(const QString &error);
+
+private:
+    // Флаг отмены текущего запроса; у каждого запроса свой
+    std::shared_ptr<std::atomic<bool>> cancel_;
+};
+
+#endif // AITEXTGENERATOR_H
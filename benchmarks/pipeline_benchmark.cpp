@@ -0,0 +1,73 @@
+// Пропускная способность конвейера пунктуации и чисел:
+//   pipeline_benchmark [text.txt]
+// Без аргументов используется синтетический текст из строчных слов (~8 МБ в UTF-16).
+// Печатается скорость в МБ/с по размеру входного текста для каждого набора стадий.
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QTextStream>
+#include "../textpipeline.h"
+
+namespace {
+
+constexpr int kSyntheticChars = 4 * 1024 * 1024;
+constexpr int kRepeats = 5;
+
+QString MakeText(int length) {
+    static const QStringList kWords = {"the", "of", "and", "typing", "keyboard", "trainer", "speed", "слово", "клавиша"};
+    QRandomGenerator generator(42);
+    QString text;
+    text.reserve(length + 16);
+    while (text.length() < length) {
+        text += kWords.at(generator.bounded(kWords.size()));
+        text += ' ';
+    }
+    return text;
+}
+
+double MeasureMbPerSecond(TextPipeline &pipeline, const QString &text) {
+    QRandomGenerator rng(7);
+    qsizetype produced = 0;
+    QElapsedTimer timer;
+    timer.start();
+    for (int i = 0; i < kRepeats; ++i) {
+        produced += pipeline.transform(text, rng).size();
+    }
+    const double seconds = double(timer.nsecsElapsed()) / 1e9;
+    const double megabytes = double(text.size()) * sizeof(QChar) * kRepeats / (1024.0 * 1024.0);
+    // Используем результат, чтобы вызовы не были выброшены оптимизатором
+    return produced > 0 ? megabytes / seconds : -1;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    QCoreApplication app(argc, argv);
+    QTextStream out(stdout);
+
+    QString text;
+    const QStringList args = app.arguments();
+    if (args.size() == 2) {
+        QFile file(args.at(1));
+        if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+            out << "cannot read " << args.at(1) << '\n';
+            return 1;
+        }
+        text = QString::fromUtf8(file.readAll());
+    } else {
+        text = MakeText(kSyntheticChars);
+    }
+
+    out << "input, MB:\t" << QString::number(double(text.size()) * sizeof(QChar) / (1024.0 * 1024.0), 'f', 2) << '\n';
+
+    TextPipeline pipeline;
+    out << "no stages, MB/s:\t" << QString::number(MeasureMbPerSecond(pipeline, text), 'f', 1) << '\n';
+
+    pipeline.addStage(std::make_unique<CapitalizeTransform>());
+    pipeline.addStage(std::make_unique<PunctuationTransform>(PunctuationStyle::Latin));
+    out << "punctuation, MB/s:\t" << QString::number(MeasureMbPerSecond(pipeline, text), 'f', 1) << '\n';
+
+    pipeline.addStage(std::make_unique<NumbersTransform>());
+    out << "punctuation + numbers, MB/s:\t" << QString::number(MeasureMbPerSecond(pipeline, text), 'f', 1) << '\n';
+    return 0;
+}
@@ -0,0 +1,54 @@
+// Замер стоимости одного нажатия в поле набора при росте длины текста.
+// Запуск без дисплея: QT_QPA_PLATFORM=offscreen ./render_benchmark
+#include <QApplication>
+#include <QElapsedTimer>
+#include <QRandomGenerator>
+#include <QTextStream>
+#include "../typingview.h"
+
+namespace {
+
+constexpr int kKeystrokes = 2000;
+constexpr int kCaretMargin = 40;
+constexpr int kTextLengths[] = {100, 1000, 10000, 100000};
+
+QString MakeText(int length) {
+    static const QStringList kWords = {"the", "of", "and", "typing", "keyboard", "trainer", "speed", "word"};
+    QString text;
+    text.reserve(length + 16);
+    while (text.length() < length) {
+        text += kWords.at(QRandomGenerator::global()->bounded(kWords.size()));
+        text += ' ';
+    }
+    text.truncate(length);
+    return text;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    QApplication app(argc, argv);
+    QTextStream out(stdout);
+
+    out << "length\tus/keystroke\n";
+    for (int length : kTextLengths) {
+        TypingView view;
+        view.setFixedSize(1200, 500);
+        view.setTargetText(MakeText(length));
+        view.show();
+        QApplication::processEvents();
+
+        const int keystrokes = qMin(kKeystrokes, length);
+        QElapsedTimer timer;
+        timer.start();
+        for (int i = 0; i < keystrokes; ++i) {
+            view.setCharState(i, 1, i % 17 == 0 ? CharState::Error : CharState::Correct);
+            view.setCaret(i + 1);
+            // Перерисовываем синхронно область вокруг каретки — то, что попадает в кадр после нажатия
+            view.repaint(view.caretRect().adjusted(-kCaretMargin, 0, kCaretMargin, 0));
+        }
+        const double us = static_cast<double>(timer.nsecsElapsed()) / 1000.0 / keystrokes;
+        out << length << '\t' << QString::number(us, 'f', 2) << '\n';
+    }
+    return 0;
+}
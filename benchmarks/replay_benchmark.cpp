@@ -0,0 +1,132 @@
+// Прогон потоков нажатий через TypingSession без дисплея.
+// Без аргументов строится синтетический поток с известным числом ошибок
+// и проверяется подсчет; с аргументами воспроизводится запись:
+//   replay_benchmark <target.txt> <keystrokes.tsv>
+// где каждая строка keystrokes.tsv — "<время, нс>\t<код символа>", код 8 — Backspace.
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QRandomGenerator>
+#include <QTextStream>
+#include <QVector>
+#include "../typingsession.h"
+
+namespace {
+
+constexpr char32_t kBackspaceCode = 8;
+constexpr int kSyntheticLength = 100000;
+constexpr int kSyntheticErrorEvery = 50;
+constexpr qint64 kSyntheticIntervalNs = 150'000'000;
+constexpr int kRepeats = 50;
+
+struct ReplayKey {
+    qint64 timestampNs;
+    char32_t codepoint;
+};
+
+QString MakeText(int length) {
+    static const QStringList kWords = {"the", "of", "and", "typing", "keyboard", "trainer", "speed", "word"};
+    QRandomGenerator generator(42);
+    QString text;
+    text.reserve(length + 16);
+    while (text.length() < length) {
+        text += kWords.at(generator.bounded(kWords.size()));
+        text += ' ';
+    }
+    text.truncate(length);
+    return text;
+}
+
+// Каждый kSyntheticErrorEvery-й символ набирается с ошибкой
+QVector<ReplayKey> MakeStream(const QString &text, int *expectedErrors) {
+    QVector<ReplayKey> keys;
+    keys.reserve(text.length());
+    *expectedErrors = 0;
+    for (int i = 0; i < text.length(); ++i) {
+        char32_t code = text.at(i).unicode();
+        if (i % kSyntheticErrorEvery == kSyntheticErrorEvery - 1) {
+            code = code == 'x' ? 'y' : 'x';
+            ++*expectedErrors;
+        }
+        keys.append({i * kSyntheticIntervalNs, code});
+    }
+    return keys;
+}
+
+bool LoadRecording(const QString &textPath, const QString &keysPath, QString *text, QVector<ReplayKey> *keys) {
+    QFile textFile(textPath);
+    QFile keysFile(keysPath);
+    if (!textFile.open(QIODevice::ReadOnly | QIODevice::Text) || !keysFile.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        return false;
+    }
+
+    *text = QString::fromUtf8(textFile.readAll());
+    QTextStream in(&keysFile);
+    while (!in.atEnd()) {
+        const QStringList fields = in.readLine().split('\t');
+        if (fields.size() == 2) {
+            keys->append({fields.at(0).toLongLong(), fields.at(1).toUInt()});
+        }
+    }
+    return true;
+}
+
+void Replay(TypingSession &session, const QString &text, const QVector<ReplayKey> &keys) {
+    session.reset(text);
+    // Буфер на один символ переиспользуется, чтобы не мерить выделения памяти
+    QString typed(1, QChar());
+    for (const ReplayKey &key : keys) {
+        if (key.codepoint == kBackspaceCode) {
+            session.backspace(key.timestampNs);
+        } else if (QChar::requiresSurrogates(key.codepoint)) {
+            session.type(QString::fromUcs4(&key.codepoint, 1), key.timestampNs);
+        } else {
+            typed.data()[0] = QChar(static_cast<char16_t>(key.codepoint));
+            session.type(typed, key.timestampNs);
+        }
+    }
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    QCoreApplication app(argc, argv);
+    QTextStream out(stdout);
+
+    QString text;
+    QVector<ReplayKey> keys;
+    int expectedErrors = -1;
+
+    const QStringList args = app.arguments();
+    if (args.size() == 3) {
+        if (!LoadRecording(args.at(1), args.at(2), &text, &keys)) {
+            out << "cannot read recording\n";
+            return 1;
+        }
+    } else {
+        text = MakeText(kSyntheticLength);
+        keys = MakeStream(text, &expectedErrors);
+    }
+
+    TypingSession session;
+    QElapsedTimer timer;
+    timer.start();
+    for (int i = 0; i < kRepeats; ++i) {
+        Replay(session, text, keys);
+    }
+    const double seconds = static_cast<double>(timer.nsecsElapsed()) / 1e9;
+    const double keysPerSecond = static_cast<double>(keys.size()) * kRepeats / seconds;
+
+    out << "keys:\t" << keys.size() << '\n'
+        << "Mkeys/s:\t" << QString::number(keysPerSecond / 1e6, 'f', 2) << '\n'
+        << "raw wpm:\t" << QString::number(session.finalRawWpm(), 'f', 4) << '\n'
+        << "accuracy:\t" << QString::number(session.accuracy(), 'f', 4) << '\n'
+        << "wpm:\t" << QString::number(session.finalWpm(), 'f', 4) << '\n';
+
+    // Для синтетического потока результат известен заранее
+    if (expectedErrors >= 0 && (session.errorCount() != expectedErrors || !session.isFinished())) {
+        out << "scoring mismatch: expected " << expectedErrors << " errors, got " << session.errorCount() << '\n';
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,96 @@
+// Скорость сборки текста из набора слов:
+//   word_benchmark [набор.kwp | набор.json]
+// Без аргументов используется синтетический набор на 100k слов, упорядоченный по частоте.
+// Для каждого объема печатается среднее время равномерной и частотной выборки.
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTextStream>
+#include "../wordpack.h"
+#include "../wordsampler.h"
+#include "../wordselector.h"
+
+namespace {
+
+constexpr int kSyntheticWords = 100000;
+constexpr int kRepeats = 200;
+const int kCounts[] = {15, 500, 5000, 10000};
+
+QByteArray MakeSyntheticJson() {
+    QJsonArray words;
+    for (int i = 0; i < kSyntheticWords; ++i) {
+        words.append(QString("слово%1").arg(i));
+    }
+    return QJsonDocument(QJsonObject {
+        { "name", "synthetic_100k" },
+        { "orderedByFrequency", true },
+        { "words", words },
+    }).toJson(QJsonDocument::Compact);
+}
+
+bool OpenWords(const QString &path, WordPack *words) {
+    if (words->open(path)) {
+        return true;
+    }
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    QString error;
+    return words->openData(WordPack::compileJson(file.readAll(), &error));
+}
+
+template <typename Select>
+double MeasureUs(Select select) {
+    qsizetype total = 0;
+    QElapsedTimer timer;
+    timer.start();
+    for (int i = 0; i < kRepeats; ++i) {
+        total += select().size();
+    }
+    const double us = double(timer.nsecsElapsed()) / 1e3 / kRepeats;
+    // Используем результат, чтобы цикл не был выброшен оптимизатором
+    return total > 0 ? us : -1;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    QCoreApplication app(argc, argv);
+    QTextStream out(stdout);
+
+    WordPack words;
+    const QStringList args = app.arguments();
+    if (args.size() == 2) {
+        if (!OpenWords(args.at(1), &words)) {
+            out << "cannot read " << args.at(1) << '\n';
+            return 1;
+        }
+    } else {
+        QString error;
+        words.openData(WordPack::compileJson(MakeSyntheticJson(), &error));
+    }
+
+    QElapsedTimer buildTimer;
+    buildTimer.start();
+    WordSampler sampler;
+    sampler.build(words);
+    const double buildMs = double(buildTimer.nsecsElapsed()) / 1e6;
+
+    out << "words:\t" << words.count() << '\n'
+        << "alias table build, ms:\t" << QString::number(buildMs, 'f', 3) << '\n'
+        << "count\tuniform, us\tweighted, us\n";
+
+    WordSelector selector;
+    QRandomGenerator rng(42);
+    for (int count : kCounts) {
+        const double uniform = MeasureUs([&] { return selector.selectUniform(words, count, rng); });
+        const double weighted = MeasureUs([&] { return selector.selectWeighted(words, sampler, count, rng); });
+        out << count << '\t' << QString::number(uniform, 'f', 2) << '\t'
+            << QString::number(weighted, 'f', 2) << '\n';
+    }
+    return 0;
+}
@@ -0,0 +1,81 @@
+#include "bookreader.h"
+
+namespace {
+bool IsContinuationByte(uchar byte) {
+    return (byte & 0xC0) == 0x80;
+}
+
+bool IsSpaceByte(uchar byte) {
+    return byte == ' ' || byte == '\n' || byte == '\r' || byte == '\t';
+}
+}
+
+BookReader::~BookReader() {
+    close();
+}
+
+bool BookReader::open(const QString &path) {
+    close();
+
+    file_.setFileName(path);
+    if (!file_.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    size_ = file_.size();
+    if (size_ == 0) {
+        file_.close();
+        return false;
+    }
+
+    data_ = file_.map(0, size_);
+    if (data_ == nullptr) {
+        file_.close();
+        size_ = 0;
+        return false;
+    }
+    return true;
+}
+
+void BookReader::close() {
+    if (data_ != nullptr) {
+        file_.unmap(const_cast<uchar *>(data_));
+        data_ = nullptr;
+    }
+    if (file_.isOpen()) {
+        file_.close();
+    }
+    size_ = 0;
+}
+
+QString BookReader::page(qint64 offset, qint64 *nextOffset) const {
+    offset = qBound<qint64>(0, offset, size_);
+    // Сохраненная позиция могла указать в середину символа
+    while (offset < size_ && IsContinuationByte(data_[offset])) {
+        ++offset;
+    }
+
+    qint64 end = qMin(offset + kBookPageBytes, size_);
+    if (end < size_) {
+        // Отступаем к последнему пробелу, чтобы не резать слово
+        qint64 cut = end;
+        while (cut > offset && !IsSpaceByte(data_[cut])) {
+            --cut;
+        }
+        if (cut > offset) {
+            end = cut;
+        } else {
+            while (end > offset && IsContinuationByte(data_[end])) {
+                --end;
+            }
+        }
+    }
+
+    *nextOffset = end;
+    while (*nextOffset < size_ && IsSpaceByte(data_[*nextOffset])) {
+        ++*nextOffset;
+    }
+
+    // Переводы строк и повторные пробелы набирать неудобно — сводим их к одному пробелу
+    return QString::fromUtf8(reinterpret_cast<const char *>(data_ + offset), end - offset).simplified();
+}
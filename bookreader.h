@@ -0,0 +1,35 @@
+#ifndef BOOKREADER_H
+#define BOOKREADER_H
+
+#include <QFile>
+#include <QString>
+
+constexpr qint64 kBookPageBytes = 1536;
+
+// Большой текстовый файл (UTF-8), отображенный в память. Файл не читается
+// целиком: страница в несколько строк декодируется только когда до нее дошел
+// набор, поэтому память ограничена размером страницы, а открытие мгновенно.
+class BookReader {
+public:
+    BookReader() = default;
+    ~BookReader();
+
+    bool open(const QString &path);
+    void close();
+
+    bool isOpen() const { return data_ != nullptr; }
+    QString path() const { return file_.fileName(); }
+    qint64 size() const { return size_; }
+    bool atEnd(qint64 offset) const { return offset >= size_; }
+
+    // Страница, начинающаяся с байта offset; в nextOffset — начало следующей.
+    // Граница выбирается по пробелу и не разрезает символ UTF-8.
+    QString page(qint64 offset, qint64 *nextOffset) const;
+
+private:
+    QFile file_;
+    const uchar *data_ = nullptr;
+    qint64 size_ = 0;
+};
+
+#endif // BOOKREADER_H
@@ -48,8 +48,8 @@ CreateAccountDialog::CreateAccountDialog(Database &db, QWidget *parent)
     confirmPasswordEdit->setObjectName("inputField");
 
     // Иконка для показа/скрытия пароля
-    QIcon eyeOpenedIcon(QStringLiteral("/Users/hronov/Documents/Keyboard Trainer/icons/opened-eye.svg"));
-    QIcon eyeClosedIcon(QStringLiteral("/Users/hronov/Documents/Keyboard Trainer/icons/closed-eye.svg"));
+    QIcon eyeOpenedIcon(QStringLiteral(":/icons/opened-eye.svg"));
+    QIcon eyeClosedIcon(QStringLiteral(":/icons/closed-eye.svg"));
 
     QAction *togglePasswordAction = passwordEdit->addAction(eyeClosedIcon, QLineEdit::TrailingPosition);
     togglePasswordAction->setCheckable(true);
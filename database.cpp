@@ -61,9 +61,93 @@ bool Database::initDatabase() {
         return false;
     }
 
+    // Нажатия сессии: текст сжат qCompress, нажатия закодированы KeystrokeRecorder
+    ok = query.exec(R"(
+        CREATE TABLE IF NOT EXISTS typing_recordings (
+            session_id INTEGER PRIMARY KEY,
+            target_text BLOB NOT NULL,
+            keystrokes BLOB NOT NULL,
+            keystroke_count INTEGER NOT NULL,
+            FOREIGN KEY(session_id) REFERENCES typing_sessions(id) ON DELETE CASCADE
+        )
+    )");
+    if (!ok) {
+        qDebug() << "Error creating typing_recordings table:" << query.lastError().text();
+        return false;
+    }
+
+    // Накопленные счетчики KeyLatencyStats — одна строка на пользователя
+    ok = query.exec(R"(
+        CREATE TABLE IF NOT EXISTS key_latency_stats (
+            user_id INTEGER PRIMARY KEY,
+            data BLOB NOT NULL,
+            FOREIGN KEY(user_id) REFERENCES users(id) ON DELETE CASCADE
+        )
+    )");
+    if (!ok) {
+        qDebug() << "Error creating key_latency_stats table:" << query.lastError().text();
+        return false;
+    }
+
+    ok = query.exec(R"(
+        CREATE TABLE IF NOT EXISTS book_positions (
+            user_id INTEGER NOT NULL,
+            path TEXT NOT NULL,
+            byte_offset INTEGER NOT NULL,
+            PRIMARY KEY(user_id, path),
+            FOREIGN KEY(user_id) REFERENCES users(id) ON DELETE CASCADE
+        )
+    )");
+    if (!ok) {
+        qDebug() << "Error creating book_positions table:" << query.lastError().text();
+        return false;
+    }
+
+    // Кэш ответов AI: общий для всех пользователей, ограничен по числу текстов
+    ok = query.exec(R"(
+        CREATE TABLE IF NOT EXISTS ai_response_cache (
+            id INTEGER PRIMARY KEY AUTOINCREMENT,
+            language TEXT NOT NULL,
+            template_hash TEXT NOT NULL,
+            word_count INTEGER NOT NULL,
+            text TEXT NOT NULL,
+            created_at DATETIME DEFAULT (datetime('now', 'localtime')),
+            use_count INTEGER NOT NULL DEFAULT 0
+        )
+    )");
+    if (!ok) {
+        qDebug() << "Error creating ai_response_cache table:" << query.lastError().text();
+        return false;
+    }
+
+    ok = query.exec(R"(
+        CREATE INDEX IF NOT EXISTS ai_response_cache_key
+        ON ai_response_cache (language, template_hash, word_count, use_count)
+    )");
+    if (!ok) {
+        qDebug() << "Error creating ai_response_cache index:" << query.lastError().text();
+        return false;
+    }
+
+    ok = query.exec(R"(
+        CREATE TABLE IF NOT EXISTS ai_cache_stats (
+            id INTEGER PRIMARY KEY CHECK (id = 1),
+            hits INTEGER NOT NULL DEFAULT 0,
+            misses INTEGER NOT NULL DEFAULT 0
+        )
+    )");
+    if (!ok || !query.exec("INSERT OR IGNORE INTO ai_cache_stats (id) VALUES (1)")) {
+        qDebug() << "Error creating ai_cache_stats table:" << query.lastError().text();
+        return false;
+    }
+
     return true;
 }
 
+static QString templateHash(const QString &promptTemplate) {
+    return QCryptographicHash::hash(promptTemplate.toUtf8(), QCryptographicHash::Sha1).toHex();
+}
+
 QString Database::hashPassword(const QString &password) {
     QString salt = "some_random_salt";
     return QString(QCryptographicHash::hash((password + salt).toUtf8(), QCryptographicHash::Sha256).toHex());
@@ -152,7 +236,8 @@ UserSettings Database::getUserSettings(const QString &username) {
     return settings;
 }
 
-bool Database::saveTypingSession(const QString &username, double wpm, double accuracy) {
+bool Database::saveTypingSession(const QString &username, double wpm, double accuracy,
+                                 const QString &targetText, const QByteArray &keystrokes, int keystrokeCount) {
     QSqlQuery query(db);
     query.prepare("SELECT id FROM users WHERE username = :username");
     query.bindValue(":username", username);
@@ -173,6 +258,23 @@ bool Database::saveTypingSession(const QString &username, double wpm, double acc
         qDebug() << "Failed to save typing session:" << query.lastError().text();
         return false;
     }
+
+    if (keystrokes.isEmpty()) {
+        return true;
+    }
+
+    const int session_id = query.lastInsertId().toInt();
+    query.prepare("INSERT INTO typing_recordings (session_id, target_text, keystrokes, keystroke_count) "
+                  "VALUES (:session_id, :target_text, :keystrokes, :keystroke_count)");
+    query.bindValue(":session_id", session_id);
+    query.bindValue(":target_text", qCompress(targetText.toUtf8()));
+    query.bindValue(":keystrokes", keystrokes);
+    query.bindValue(":keystroke_count", keystrokeCount);
+
+    if (!query.exec()) {
+        qDebug() << "Failed to save typing recording:" << query.lastError().text();
+        return false;
+    }
     return true;
 }
 
@@ -201,3 +303,247 @@ QVector<QPair<QDateTime, double>> Database::getTypingSessionsForUser(const QStri
 
     return result;
 }
+
+QVector<TypingRecordingInfo> Database::getTypingRecordingsForUser(const QString &username, int limit) {
+    QVector<TypingRecordingInfo> result;
+
+    QSqlQuery query(db);
+    query.prepare(R"(
+        SELECT ts.id, ts.session_date, ts.wpm, tr.keystroke_count
+        FROM typing_recordings tr
+        JOIN typing_sessions ts ON tr.session_id = ts.id
+        JOIN users u ON ts.user_id = u.id
+        WHERE u.username = :username
+        ORDER BY ts.session_date DESC
+        LIMIT :limit
+    )");
+    query.bindValue(":username", username);
+    query.bindValue(":limit", limit);
+
+    if (query.exec()) {
+        while (query.next()) {
+            TypingRecordingInfo info;
+            info.session_id = query.value(0).toInt();
+            info.session_date = query.value(1).toDateTime();
+            info.wpm = query.value(2).toDouble();
+            info.keystroke_count = query.value(3).toInt();
+            result.append(info);
+        }
+    } else {
+        qDebug() << "Failed to get typing recordings:" << query.lastError().text();
+    }
+
+    return result;
+}
+
+bool Database::getTypingRecording(int sessionId, QString &targetText, QByteArray &keystrokes) {
+    QSqlQuery query(db);
+    query.prepare("SELECT target_text, keystrokes FROM typing_recordings WHERE session_id = :session_id");
+    query.bindValue(":session_id", sessionId);
+
+    if (!query.exec() || !query.next()) {
+        qDebug() << "Failed to get typing recording:" << query.lastError().text();
+        return false;
+    }
+
+    targetText = QString::fromUtf8(qUncompress(query.value(0).toByteArray()));
+    keystrokes = query.value(1).toByteArray();
+    return true;
+}
+
+bool Database::saveKeyLatencyStats(const QString &username, const QByteArray &data) {
+    QSqlQuery query(db);
+    query.prepare(R"(
+        INSERT OR REPLACE INTO key_latency_stats (user_id, data)
+        SELECT id, :data FROM users WHERE username = :username
+    )");
+    query.bindValue(":data", data);
+    query.bindValue(":username", username);
+
+    if (!query.exec()) {
+        qDebug() << "Failed to save key latency stats:" << query.lastError().text();
+        return false;
+    }
+    return true;
+}
+
+QByteArray Database::getKeyLatencyStats(const QString &username) {
+    QSqlQuery query(db);
+    query.prepare(R"(
+        SELECT ks.data
+        FROM key_latency_stats ks
+        JOIN users u ON ks.user_id = u.id
+        WHERE u.username = :username
+    )");
+    query.bindValue(":username", username);
+
+    if (query.exec() && query.next()) {
+        return query.value(0).toByteArray();
+    }
+    return QByteArray();
+}
+
+bool Database::saveBookPosition(const QString &username, const QString &path, qint64 offset) {
+    QSqlQuery query(db);
+    query.prepare(R"(
+        INSERT OR REPLACE INTO book_positions (user_id, path, byte_offset)
+        SELECT id, :path, :offset FROM users WHERE username = :username
+    )");
+    query.bindValue(":path", path);
+    query.bindValue(":offset", offset);
+    query.bindValue(":username", username);
+
+    if (!query.exec()) {
+        qDebug() << "Failed to save book position:" << query.lastError().text();
+        return false;
+    }
+    return true;
+}
+
+qint64 Database::getBookPosition(const QString &username, const QString &path) {
+    QSqlQuery query(db);
+    query.prepare(R"(
+        SELECT bp.byte_offset
+        FROM book_positions bp
+        JOIN users u ON bp.user_id = u.id
+        WHERE u.username = :username AND bp.path = :path
+    )");
+    query.bindValue(":username", username);
+    query.bindValue(":path", path);
+
+    if (query.exec() && query.next()) {
+        return query.value(0).toLongLong();
+    }
+    return 0;
+}
+
+bool Database::saveAiResponse(const AiCacheKey &key, const QString &text, bool used, int maxEntries) {
+    QSqlQuery query(db);
+    query.prepare(R"(
+        INSERT INTO ai_response_cache (language, template_hash, word_count, text, use_count)
+        VALUES (:language, :template_hash, :word_count, :text, :use_count)
+    )");
+    query.bindValue(":language", key.language);
+    query.bindValue(":template_hash", templateHash(key.prompt_template));
+    query.bindValue(":word_count", key.word_count);
+    query.bindValue(":text", text);
+    query.bindValue(":use_count", used ? 1 : 0);
+
+    if (!query.exec()) {
+        qDebug() << "Failed to save AI response:" << query.lastError().text();
+        return false;
+    }
+
+    // Сверх лимита вытесняются сначала самые набранные, среди них — самые старые;
+    // ненабранные тексты уходят последними
+    query.prepare(R"(
+        DELETE FROM ai_response_cache WHERE id IN (
+            SELECT id FROM ai_response_cache
+            ORDER BY use_count DESC, created_at ASC, id ASC
+            LIMIT max(0, (SELECT COUNT(*) FROM ai_response_cache) - :max_entries)
+        )
+    )");
+    query.bindValue(":max_entries", maxEntries);
+
+    if (!query.exec()) {
+        qDebug() << "Failed to evict AI responses:" << query.lastError().text();
+        return false;
+    }
+    return true;
+}
+
+bool Database::takeAiResponse(const AiCacheKey &key, bool allowUsed, QString &text) {
+    // Сначала ненабранные тексты, затем — если разрешено — наименее набранные
+    QSqlQuery query(db);
+    query.prepare(R"(
+        SELECT id, text FROM ai_response_cache
+        WHERE language = :language AND template_hash = :template_hash
+          AND word_count = :word_count AND (use_count = 0 OR :allow_used)
+        ORDER BY use_count ASC, created_at ASC, id ASC
+        LIMIT 1
+    )");
+    query.bindValue(":language", key.language);
+    query.bindValue(":template_hash", templateHash(key.prompt_template));
+    query.bindValue(":word_count", key.word_count);
+    query.bindValue(":allow_used", allowUsed ? 1 : 0);
+
+    if (!query.exec() || !query.next()) {
+        return false;
+    }
+    const qint64 id = query.value(0).toLongLong();
+    text = query.value(1).toString();
+
+    query.prepare("UPDATE ai_response_cache SET use_count = use_count + 1 WHERE id = :id");
+    query.bindValue(":id", id);
+    if (!query.exec()) {
+        qDebug() << "Failed to update AI response usage:" << query.lastError().text();
+    }
+    return true;
+}
+
+QStringList Database::getUnusedAiResponses(const AiCacheKey &key, int limit) {
+    // Тексты не помечаются набранными: это делает markAiResponseUsed при показе
+    QStringList texts;
+    QSqlQuery query(db);
+    query.prepare(R"(
+        SELECT text FROM ai_response_cache
+        WHERE language = :language AND template_hash = :template_hash
+          AND word_count = :word_count AND use_count = 0
+        ORDER BY created_at ASC, id ASC
+        LIMIT :limit
+    )");
+    query.bindValue(":language", key.language);
+    query.bindValue(":template_hash", templateHash(key.prompt_template));
+    query.bindValue(":word_count", key.word_count);
+    query.bindValue(":limit", limit);
+
+    if (!query.exec()) {
+        qDebug() << "Failed to get unused AI responses:" << query.lastError().text();
+        return texts;
+    }
+    while (query.next()) {
+        texts.append(query.value(0).toString());
+    }
+    return texts;
+}
+
+bool Database::markAiResponseUsed(const AiCacheKey &key, const QString &text) {
+    QSqlQuery query(db);
+    query.prepare(R"(
+        UPDATE ai_response_cache SET use_count = use_count + 1
+        WHERE language = :language AND template_hash = :template_hash
+          AND word_count = :word_count AND text = :text
+    )");
+    query.bindValue(":language", key.language);
+    query.bindValue(":template_hash", templateHash(key.prompt_template));
+    query.bindValue(":word_count", key.word_count);
+    query.bindValue(":text", text);
+
+    if (!query.exec()) {
+        qDebug() << "Failed to mark AI response used:" << query.lastError().text();
+        return false;
+    }
+    return true;
+}
+
+void Database::recordAiCacheLookup(bool hit) {
+    QSqlQuery query(db);
+    if (!query.exec(hit ? "UPDATE ai_cache_stats SET hits = hits + 1 WHERE id = 1"
+                        : "UPDATE ai_cache_stats SET misses = misses + 1 WHERE id = 1")) {
+        qDebug() << "Failed to record AI cache lookup:" << query.lastError().text();
+    }
+}
+
+AiCacheStats Database::getAiCacheStats() {
+    AiCacheStats stats {0, 0, 0, 0};
+    QSqlQuery query(db);
+    if (query.exec("SELECT COUNT(*), COALESCE(SUM(use_count = 0), 0) FROM ai_response_cache") && query.next()) {
+        stats.entries = query.value(0).toInt();
+        stats.unused = query.value(1).toInt();
+    }
+    if (query.exec("SELECT hits, misses FROM ai_cache_stats WHERE id = 1") && query.next()) {
+        stats.hits = query.value(0).toLongLong();
+        stats.misses = query.value(1).toLongLong();
+    }
+    return stats;
+}
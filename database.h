@@ -3,6 +3,8 @@
 
 #include <QObject>
 #include <QColor>
+#include <QDateTime>
+#include <QStringList>
 #include <QtSql/qsqldatabase.h>
 #include <QCryptographicHash>
 
@@ -18,6 +20,27 @@ struct UserSettings {
     QString caret_style;
 };
 
+struct TypingRecordingInfo {
+    int session_id;
+    QDateTime session_date;
+    double wpm;
+    int keystroke_count;
+};
+
+// Ключ кэша ответов AI: язык, шаблон запроса (хранится его SHA-1) и число слов
+struct AiCacheKey {
+    QString language;
+    QString prompt_template;
+    int word_count;
+};
+
+struct AiCacheStats {
+    int entries;
+    int unused;
+    qint64 hits;
+    qint64 misses;
+};
+
 class Database : public QObject
 {
     Q_OBJECT
@@ -26,13 +49,28 @@ public:
     ~Database();
 
     bool initDatabase();
+    bool isOpen() const { return db.isOpen(); }
     bool createUser(const QString &username, const QString &password);
     bool authenticateUser(const QString &username, const QString &password);
     bool userExists(const QString &username);
     bool updateUserSetting(const QString &username, const QString &settingName, const QVariant &value);
     UserSettings getUserSettings(const QString &username);
-    bool saveTypingSession(const QString &username, double wpm, double accuracy);
+    bool saveTypingSession(const QString &username, double wpm, double accuracy,
+                           const QString &targetText = QString(), const QByteArray &keystrokes = QByteArray(),
+                           int keystrokeCount = 0);
     QVector<QPair<QDateTime, double>> getTypingSessionsForUser(const QString &username);
+    QVector<TypingRecordingInfo> getTypingRecordingsForUser(const QString &username, int limit);
+    bool getTypingRecording(int sessionId, QString &targetText, QByteArray &keystrokes);
+    bool saveKeyLatencyStats(const QString &username, const QByteArray &data);
+    QByteArray getKeyLatencyStats(const QString &username);
+    bool saveBookPosition(const QString &username, const QString &path, qint64 offset);
+    qint64 getBookPosition(const QString &username, const QString &path);
+    bool saveAiResponse(const AiCacheKey &key, const QString &text, bool used, int maxEntries);
+    bool takeAiResponse(const AiCacheKey &key, bool allowUsed, QString &text);
+    QStringList getUnusedAiResponses(const AiCacheKey &key, int limit);
+    bool markAiResponseUsed(const AiCacheKey &key, const QString &text);
+    void recordAiCacheLookup(bool hit);
+    AiCacheStats getAiCacheStats();
 
 
 private:
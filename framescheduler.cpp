@@ -0,0 +1,51 @@
+#include "framescheduler.h"
+
+namespace {
+constexpr double kNsInSecond = 1e9;
+constexpr qint64 kNsInMs = 1000 * 1000;
+}
+
+FrameScheduler::FrameScheduler(QObject *parent)
+    : QObject(parent),
+      frameIntervalNs_(qint64(kNsInSecond / kDefaultRefreshRate)),
+      lastFrameNs_(-frameIntervalNs_) {
+    timer_.setSingleShot(true);
+    timer_.setTimerType(Qt::PreciseTimer);
+    connect(&timer_, &QTimer::timeout, this, &FrameScheduler::fire);
+    clock_.start();
+}
+
+void FrameScheduler::setRefreshRate(double hz) {
+    frameIntervalNs_ = qint64(kNsInSecond / (hz > 0 ? hz : kDefaultRefreshRate));
+}
+
+void FrameScheduler::requestFrame() {
+    if (!inPass_) {
+        inPass_ = true;
+        ++requested_;
+        // Отложенный вызов выполнится после всех запросов текущего события
+        QMetaObject::invokeMethod(this, [this]() { inPass_ = false; }, Qt::QueuedConnection);
+        if (pending_) {
+            ++skipped_;
+        }
+    }
+    if (pending_) {
+        return;
+    }
+
+    pending_ = true;
+    const qint64 sinceLastFrame = clock_.nsecsElapsed() - lastFrameNs_;
+    if (sinceLastFrame >= frameIntervalNs_) {
+        QMetaObject::invokeMethod(this, &FrameScheduler::fire, Qt::QueuedConnection);
+        return;
+    }
+
+    const qint64 remainingNs = frameIntervalNs_ - sinceLastFrame;
+    timer_.start(int((remainingNs + kNsInMs - 1) / kNsInMs));
+}
+
+void FrameScheduler::fire() {
+    pending_ = false;
+    lastFrameNs_ = clock_.nsecsElapsed();
+    emit frame();
+}
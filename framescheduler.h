@@ -0,0 +1,47 @@
+#ifndef FRAMESCHEDULER_H
+#define FRAMESCHEDULER_H
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <QTimer>
+
+constexpr double kDefaultRefreshRate = 60.0;
+
+// Сводит запросы на перерисовку к одному кадру на период обновления экрана.
+// Все запросы одного прохода цикла событий (окраска символа и каретка одного
+// нажатия) уходят в один кадр, который выдается сразу после этого прохода,
+// если с прошлого кадра прошел период; иначе — на границе кадра. Пропущенной
+// считается перерисовка, когда нажатие из другого события попало в уже
+// запланированный кадр.
+class FrameScheduler : public QObject {
+    Q_OBJECT
+
+public:
+    explicit FrameScheduler(QObject *parent = nullptr);
+
+    void setRefreshRate(double hz);
+    void requestFrame();
+
+    // Число проходов цикла событий, запросивших кадр
+    quint64 requestedFrames() const { return requested_; }
+    quint64 skippedFrames() const { return skipped_; }
+
+signals:
+    void frame();
+
+private:
+    void fire();
+
+    QTimer timer_;
+    QElapsedTimer clock_;
+    qint64 frameIntervalNs_;
+    qint64 lastFrameNs_;
+    bool pending_ = false;
+    // Запрос из текущего прохода цикла событий уже учтен
+    bool inPass_ = false;
+
+    quint64 requested_ = 0;
+    quint64 skipped_ = 0;
+};
+
+#endif // FRAMESCHEDULER_H
@@ -0,0 +1,78 @@
+#include "graphemeindex.h"
+#include <QTextBoundaryFinder>
+#include <algorithm>
+
+namespace {
+// Текст без суррогатов и комбинируемых знаков делится на графемы по одному символу
+bool IsSimpleText(const QString &text) {
+    for (QChar c : text) {
+        if (c.isSurrogate() || c.isMark() || c.unicode() == 0x200D || c.unicode() == '\r'
+            || (c.unicode() >= 0xFE00 && c.unicode() <= 0xFE0F)
+            || (c.unicode() >= 0x1100 && c.unicode() <= 0x11FF)) {
+            return false;
+        }
+    }
+    return true;
+}
+}
+
+void GraphemeIndex::build(const QString &text) {
+    starts_.clear();
+    starts_.reserve(text.length() + 1);
+
+    if (IsSimpleText(text)) {
+        for (int i = 0; i <= text.length(); ++i) {
+            starts_.append(i);
+        }
+        return;
+    }
+
+    QTextBoundaryFinder finder(QTextBoundaryFinder::Grapheme, text);
+    starts_.append(0);
+    for (qsizetype pos = finder.toNextBoundary(); pos > 0; pos = finder.toNextBoundary()) {
+        starts_.append(int(pos));
+    }
+    if (starts_.last() != text.length()) {
+        starts_.append(text.length());
+    }
+}
+
+void GraphemeIndex::append(const QString &text) {
+    if (starts_.isEmpty()) {
+        build(text);
+        return;
+    }
+    const int base = starts_.last();
+    const GraphemeIndex appended(text);
+    starts_.reserve(starts_.size() + appended.count());
+    for (int i = 1; i < appended.starts_.size(); ++i) {
+        starts_.append(base + appended.starts_[i]);
+    }
+}
+
+void GraphemeIndex::removeFront(int clusters) {
+    if (clusters <= 0) {
+        return;
+    }
+    const int shift = starts_[clusters];
+    starts_.remove(0, clusters);
+    for (int &start : starts_) {
+        start -= shift;
+    }
+}
+
+int GraphemeIndex::clusterAt(int position) const {
+    const auto it = std::upper_bound(starts_.cbegin(), starts_.cend(), position);
+    return qMax(0, int(it - starts_.cbegin()) - 1);
+}
+
+char32_t GraphemeIndex::firstCodepoint(QStringView cluster) {
+    if (cluster.isEmpty()) {
+        return 0;
+    }
+    const QChar first = cluster.at(0);
+    if (first.isHighSurrogate() && cluster.size() > 1 && cluster.at(1).isLowSurrogate()) {
+        return QChar::surrogateToUcs4(first, cluster.at(1));
+    }
+    return first.unicode();
+}
@@ -0,0 +1,35 @@
+#ifndef GRAPHEMEINDEX_H
+#define GRAPHEMEINDEX_H
+
+#include <QString>
+#include <QStringView>
+#include <QVector>
+
+// Таблица границ графем (видимых символов) текста. Строится один раз,
+// после чего начало и длина любой графемы получаются за O(1).
+// Суррогатные пары, эмодзи и комбинируемые знаки считаются одним символом.
+class GraphemeIndex {
+public:
+    GraphemeIndex() = default;
+    explicit GraphemeIndex(const QString &text) { build(text); }
+
+    void build(const QString &text);
+    // Дописывает границы графем текста, добавленного в конец (с границы слова)
+    void append(const QString &text);
+    // Убирает первые clusters графем; позиции остальных сдвигаются к нулю
+    void removeFront(int clusters);
+
+    int count() const { return starts_.isEmpty() ? 0 : int(starts_.size()) - 1; }
+    int start(int cluster) const { return starts_[cluster]; }
+    int end(int cluster) const { return starts_[cluster + 1]; }
+    int length(int cluster) const { return starts_[cluster + 1] - starts_[cluster]; }
+    // Номер графемы, начинающейся в позиции position или содержащей ее
+    int clusterAt(int position) const;
+
+    static char32_t firstCodepoint(QStringView cluster);
+
+private:
+    QVector<int> starts_;
+};
+
+#endif // GRAPHEMEINDEX_H
@@ -0,0 +1,133 @@
+#include "keyboardheatmap.h"
+#include <QPainter>
+#include <algorithm>
+
+namespace {
+constexpr int kKeySize = 44;
+constexpr int kKeySpacing = 6;
+constexpr int kRowIndent = 18;
+constexpr int kSlowBigramsShown = 10;
+constexpr int kBigramLineHeight = 22;
+constexpr int kHeatmapMargin = 12;
+
+const QStringList kQwertyRows = {"1234567890", "qwertyuiop", "asdfghjkl", "zxcvbnm"};
+const QStringList kJcukenRows = {"1234567890", "йцукенгшщзхъ", "фывапролджэ", "ячсмитьбю"};
+
+int SamplesIn(const KeyLatencyStats &stats, const QStringList &rows) {
+    int samples = 0;
+    for (const QString &row : rows) {
+        for (QChar c : row) {
+            samples += stats.keys().value(c.unicode()).samples;
+        }
+    }
+    return samples;
+}
+
+QString CodepointToString(char32_t codepoint) {
+    return codepoint == ' ' ? QStringLiteral("␣") : QString::fromUcs4(&codepoint, 1);
+}
+}
+
+KeyboardHeatmap::KeyboardHeatmap(const KeyLatencyStats &stats, QWidget *parent)
+    : QWidget(parent), stats_(stats) {
+    // Раскладка выбирается по тому, на каких клавишах больше данных
+    rows_ = SamplesIn(stats_, kJcukenRows) > SamplesIn(stats_, kQwertyRows) ? kJcukenRows : kQwertyRows;
+
+    bool first = true;
+    for (const QString &row : rows_) {
+        for (QChar c : row) {
+            const LatencyCounter counter = stats_.keys().value(c.unicode());
+            if (counter.samples == 0) {
+                continue;
+            }
+            const double mean = counter.meanMs();
+            minMeanMs_ = first ? mean : qMin(minMeanMs_, mean);
+            maxMeanMs_ = first ? mean : qMax(maxMeanMs_, mean);
+            first = false;
+        }
+    }
+
+    QVector<quint64> bigrams;
+    for (auto it = stats_.bigrams().cbegin(); it != stats_.bigrams().cend(); ++it) {
+        if (it.value().samples > 0) {
+            bigrams.append(it.key());
+        }
+    }
+    const int shown = qMin(kSlowBigramsShown, int(bigrams.size()));
+    std::partial_sort(bigrams.begin(), bigrams.begin() + shown, bigrams.end(), [this](quint64 a, quint64 b) {
+        return stats_.bigrams().value(a).meanMs() > stats_.bigrams().value(b).meanMs();
+    });
+    for (int i = 0; i < shown; ++i) {
+        const LatencyCounter counter = stats_.bigrams().value(bigrams[i]);
+        slowBigrams_.append(QString("%1%2  —  %3 мс (p50 %4, p95 %5), ошибки %6%")
+            .arg(CodepointToString(KeyLatencyStats::bigramFirst(bigrams[i])))
+            .arg(CodepointToString(KeyLatencyStats::bigramSecond(bigrams[i])))
+            .arg(QString::number(counter.meanMs(), 'f', 0))
+            .arg(QString::number(counter.quantileMs(0.5), 'f', 0))
+            .arg(QString::number(counter.quantileMs(0.95), 'f', 0))
+            .arg(QString::number(counter.errorRate() * 100, 'f', 1)));
+    }
+
+    setMinimumSize(sizeHint());
+}
+
+QSize KeyboardHeatmap::sizeHint() const {
+    int widest = 0;
+    for (const QString &row : rows_) {
+        widest = qMax(widest, int(row.length()));
+    }
+    const int width = kHeatmapMargin * 2 + kRowIndent * rows_.size() + widest * (kKeySize + kKeySpacing);
+    const int height = kHeatmapMargin * 3 + rows_.size() * (kKeySize + kKeySpacing)
+        + (slowBigrams_.size() + 1) * kBigramLineHeight;
+    return QSize(width, height);
+}
+
+QColor KeyboardHeatmap::colorFor(double meanMs) const {
+    // Зеленый — самые быстрые клавиши, красный — самые медленные
+    const double range = maxMeanMs_ - minMeanMs_;
+    const double t = range > 0 ? (meanMs - minMeanMs_) / range : 0.0;
+    return QColor::fromHsvF((1.0 - t) / 3.0, 0.65, 0.8);
+}
+
+void KeyboardHeatmap::paintEvent(QPaintEvent *) {
+    QPainter painter(this);
+    painter.setRenderHint(QPainter::Antialiasing);
+
+    QFont keyFont = font();
+    keyFont.setPixelSize(14);
+    QFont hintFont = font();
+    hintFont.setPixelSize(10);
+
+    int y = kHeatmapMargin;
+    for (int r = 0; r < rows_.size(); ++r) {
+        int x = kHeatmapMargin + r * kRowIndent;
+        for (QChar c : rows_[r]) {
+            const LatencyCounter counter = stats_.keys().value(c.unicode());
+            const QRect keyRect(x, y, kKeySize, kKeySize);
+
+            painter.setPen(Qt::NoPen);
+            painter.setBrush(counter.samples > 0 ? colorFor(counter.meanMs()) : QColor("#434c5e"));
+            painter.drawRoundedRect(keyRect, 6, 6);
+
+            painter.setPen(QColor("#eceff4"));
+            painter.setFont(keyFont);
+            painter.drawText(keyRect.adjusted(0, 2, 0, -kKeySize / 2), Qt::AlignCenter, QString(c));
+            if (counter.samples > 0) {
+                painter.setFont(hintFont);
+                painter.drawText(keyRect.adjusted(0, kKeySize / 2, 0, -2), Qt::AlignCenter,
+                                 QString::number(counter.quantileMs(0.5), 'f', 0));
+            }
+            x += kKeySize + kKeySpacing;
+        }
+        y += kKeySize + kKeySpacing;
+    }
+
+    y += kHeatmapMargin;
+    painter.setFont(keyFont);
+    painter.setPen(QColor("#d8dee9"));
+    painter.drawText(kHeatmapMargin, y + kBigramLineHeight / 2, "Самые медленные биграммы:");
+    for (const QString &line : slowBigrams_) {
+        y += kBigramLineHeight;
+        painter.drawText(kHeatmapMargin, y + kBigramLineHeight / 2, line);
+    }
+}
@@ -0,0 +1,31 @@
+#ifndef KEYBOARDHEATMAP_H
+#define KEYBOARDHEATMAP_H
+
+#include <QWidget>
+#include <QStringList>
+#include "keylatencystats.h"
+
+// Клавиатура, раскрашенная по средней задержке нажатия каждой клавиши,
+// и список самых медленных биграмм
+class KeyboardHeatmap : public QWidget {
+    Q_OBJECT
+
+public:
+    explicit KeyboardHeatmap(const KeyLatencyStats &stats, QWidget *parent = nullptr);
+
+    QSize sizeHint() const override;
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+
+private:
+    QColor colorFor(double meanMs) const;
+
+    KeyLatencyStats stats_;
+    QStringList rows_;
+    QStringList slowBigrams_;
+    double minMeanMs_ = 0;
+    double maxMeanMs_ = 0;
+};
+
+#endif // KEYBOARDHEATMAP_H
@@ -0,0 +1,166 @@
+#include "keylatencystats.h"
+#include <QDataStream>
+#include <QIODevice>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+constexpr quint32 kStatsFormatVersion = 1;
+// Доля ошибок 10% делает клавишу вдвое «слабее»
+constexpr double kErrorPenalty = 10.0;
+
+int BucketFor(double intervalMs) {
+    if (intervalMs <= 1.0) {
+        return 0;
+    }
+    const int bucket = static_cast<int>(std::log2(intervalMs) * kLatencyBucketsPerOctave);
+    return qMin(bucket, kLatencyBuckets - 1);
+}
+
+// Середина корзины в геометрическом смысле
+double BucketValueMs(int bucket) {
+    return std::exp2((bucket + 0.5) / kLatencyBucketsPerOctave);
+}
+
+QDataStream &operator<<(QDataStream &out, const LatencyCounter &counter) {
+    out << counter.count << counter.errors << counter.samples << counter.sumMs;
+    for (quint32 bucket : counter.buckets) {
+        out << bucket;
+    }
+    return out;
+}
+
+QDataStream &operator>>(QDataStream &in, LatencyCounter &counter) {
+    in >> counter.count >> counter.errors >> counter.samples >> counter.sumMs;
+    for (quint32 &bucket : counter.buckets) {
+        in >> bucket;
+    }
+    return in;
+}
+}
+
+void LatencyCounter::add(double intervalMs, bool error) {
+    ++count;
+    if (error) {
+        ++errors;
+    }
+    if (intervalMs < 0 || intervalMs > kMaxLatencyMs) {
+        return;
+    }
+    ++samples;
+    sumMs += intervalMs;
+    ++buckets[BucketFor(intervalMs)];
+}
+
+double LatencyCounter::meanMs() const {
+    return samples > 0 ? sumMs / samples : 0.0;
+}
+
+double LatencyCounter::quantileMs(double q) const {
+    if (samples == 0) {
+        return 0.0;
+    }
+    const double target = q * samples;
+    quint64 seen = 0;
+    for (int i = 0; i < kLatencyBuckets; ++i) {
+        seen += buckets[i];
+        if (seen >= target) {
+            return BucketValueMs(i);
+        }
+    }
+    return BucketValueMs(kLatencyBuckets - 1);
+}
+
+double LatencyCounter::errorRate() const {
+    return count > 0 ? static_cast<double>(errors) / count : 0.0;
+}
+
+void KeyLatencyStats::add(char32_t previous, char32_t current, double intervalMs, bool error) {
+    keys_[current].add(intervalMs, error);
+    if (previous != 0) {
+        bigrams_[bigramKey(previous, current)].add(intervalMs, error);
+    }
+}
+
+QVector<WeakSpot> KeyLatencyStats::weakest(int limit, quint32 minSamples,
+                                           const std::function<bool(quint64 key)> &available) const {
+    double totalMs = 0;
+    quint64 totalSamples = 0;
+    for (const LatencyCounter &counter : keys_) {
+        totalMs += counter.sumMs;
+        totalSamples += counter.samples;
+    }
+    if (totalSamples == 0) {
+        return {};
+    }
+    const double overallMeanMs = totalMs / totalSamples;
+
+    QVector<WeakSpot> spots;
+    auto consider = [&](quint64 key, const LatencyCounter &counter) {
+        if (counter.samples >= minSamples && (!available || available(key))) {
+            spots.append({key, counter.meanMs() / overallMeanMs * (1.0 + kErrorPenalty * counter.errorRate())});
+        }
+    };
+    for (auto it = keys_.cbegin(); it != keys_.cend(); ++it) {
+        if (it.key() != ' ') {
+            consider(bigramKey(0, it.key()), it.value());
+        }
+    }
+    for (auto it = bigrams_.cbegin(); it != bigrams_.cend(); ++it) {
+        if (bigramFirst(it.key()) != ' ' && bigramSecond(it.key()) != ' ') {
+            consider(it.key(), it.value());
+        }
+    }
+
+    const int count = qMin(limit, int(spots.size()));
+    std::partial_sort(spots.begin(), spots.begin() + count, spots.end(),
+                      [](const WeakSpot &a, const WeakSpot &b) { return a.score > b.score; });
+    spots.resize(count);
+    return spots;
+}
+
+QByteArray KeyLatencyStats::toByteArray() const {
+    QByteArray data;
+    QDataStream out(&data, QIODevice::WriteOnly);
+    out << kStatsFormatVersion << quint32(keys_.size()) << quint32(bigrams_.size());
+    for (auto it = keys_.cbegin(); it != keys_.cend(); ++it) {
+        out << quint32(it.key()) << it.value();
+    }
+    for (auto it = bigrams_.cbegin(); it != bigrams_.cend(); ++it) {
+        out << quint64(it.key()) << it.value();
+    }
+    return qCompress(data);
+}
+
+KeyLatencyStats KeyLatencyStats::fromByteArray(const QByteArray &data) {
+    KeyLatencyStats stats;
+    if (data.isEmpty()) {
+        return stats;
+    }
+
+    const QByteArray raw = qUncompress(data);
+    QDataStream in(raw);
+    quint32 version = 0;
+    quint32 keyCount = 0;
+    quint32 bigramCount = 0;
+    in >> version >> keyCount >> bigramCount;
+    if (version != kStatsFormatVersion) {
+        return stats;
+    }
+
+    stats.keys_.reserve(keyCount);
+    for (quint32 i = 0; i < keyCount && in.status() == QDataStream::Ok; ++i) {
+        quint32 key = 0;
+        LatencyCounter counter;
+        in >> key >> counter;
+        stats.keys_.insert(key, counter);
+    }
+    stats.bigrams_.reserve(bigramCount);
+    for (quint32 i = 0; i < bigramCount && in.status() == QDataStream::Ok; ++i) {
+        quint64 key = 0;
+        LatencyCounter counter;
+        in >> key >> counter;
+        stats.bigrams_.insert(key, counter);
+    }
+    return stats;
+}
@@ -0,0 +1,65 @@
+#ifndef KEYLATENCYSTATS_H
+#define KEYLATENCYSTATS_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QVector>
+#include <array>
+#include <functional>
+
+constexpr int kLatencyBucketsPerOctave = 4;
+constexpr int kLatencyBuckets = 48;         // 1 мс … 4 с
+constexpr double kMaxLatencyMs = 3000.0;    // паузы длиннее не считаются задержкой нажатия
+
+// Счетчики одной клавиши или пары клавиш фиксированного размера.
+// Квантили оцениваются по логарифмической гистограмме, поэтому
+// добавление — O(1), а чтение не зависит от числа нажатий.
+struct LatencyCounter {
+    quint32 count = 0;
+    quint32 errors = 0;
+    quint32 samples = 0;
+    double sumMs = 0;
+    std::array<quint32, kLatencyBuckets> buckets {};
+
+    void add(double intervalMs, bool error);
+    double meanMs() const;
+    double quantileMs(double q) const;
+    double errorRate() const;
+};
+
+// Слабое место пользователя: символ (ключ bigramKey(0, c)) или биграмма
+struct WeakSpot {
+    quint64 key;
+    double score;
+};
+
+// Накопительная статистика задержек по символам и биграммам пользователя.
+// Обновляется по мере набора и хранится целиком, без пересчета истории.
+class KeyLatencyStats {
+public:
+    // intervalMs < 0 — у нажатия нет предыдущего (первое в сессии)
+    void add(char32_t previous, char32_t current, double intervalMs, bool error);
+
+    const QHash<char32_t, LatencyCounter> &keys() const { return keys_; }
+    const QHash<quint64, LatencyCounter> &bigrams() const { return bigrams_; }
+    bool isEmpty() const { return keys_.isEmpty(); }
+
+    static quint64 bigramKey(char32_t first, char32_t second) { return (quint64(first) << 32) | second; }
+    static char32_t bigramFirst(quint64 key) { return static_cast<char32_t>(key >> 32); }
+    static char32_t bigramSecond(quint64 key) { return static_cast<char32_t>(key & 0xFFFFFFFFu); }
+
+    // Символы и биграммы с наибольшей задержкой относительно средней, с поправкой на ошибки;
+    // учитываются только набравшие minSamples замеров и, если задан available, принятые им
+    // (например, встречающиеся в текущем наборе слов)
+    QVector<WeakSpot> weakest(int limit, quint32 minSamples,
+                              const std::function<bool(quint64 key)> &available = nullptr) const;
+
+    QByteArray toByteArray() const;
+    static KeyLatencyStats fromByteArray(const QByteArray &data);
+
+private:
+    QHash<char32_t, LatencyCounter> keys_;
+    QHash<quint64, LatencyCounter> bigrams_;
+};
+
+#endif // KEYLATENCYSTATS_H
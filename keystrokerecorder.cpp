@@ -0,0 +1,104 @@
+#include "keystrokerecorder.h"
+#include "graphemeindex.h"
+
+namespace {
+constexpr int kInitialReserve = 4096;
+constexpr qint64 kNsInMs = 1000 * 1000;
+constexpr quint64 kKindMask = 0x3;
+constexpr int kKindBits = 2;
+
+bool ReadVarint(const QByteArray &data, int *pos, quint64 *value) {
+    *value = 0;
+    for (int shift = 0; *pos < data.size() && shift < 64; shift += 7) {
+        const quint8 byte = static_cast<quint8>(data.at((*pos)++));
+        *value |= quint64(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+}
+
+KeystrokeRecorder::KeystrokeRecorder() {
+    reset();
+}
+
+void KeystrokeRecorder::reset() {
+    data_.clear();
+    data_.reserve(kInitialReserve);
+    data_.append(static_cast<char>(kFormatVersion));
+    count_ = 0;
+    firstTimestampNs_ = 0;
+    lastOffsetMs_ = 0;
+}
+
+void KeystrokeRecorder::append(qint64 timestampNs, char32_t codepoint, KeystrokeKind kind) {
+    if (count_ == 0) {
+        firstTimestampNs_ = timestampNs;
+    }
+
+    // Дельта берется между округленными абсолютными смещениями, чтобы ошибка округления не накапливалась
+    const qint64 offsetMs = (timestampNs - firstTimestampNs_) / kNsInMs;
+    const quint64 deltaMs = static_cast<quint64>(qMax<qint64>(offsetMs - lastOffsetMs_, 0));
+    lastOffsetMs_ = offsetMs;
+
+    appendVarint((deltaMs << kKindBits) | static_cast<quint64>(kind));
+    if (kind == KeystrokeKind::Error) {
+        appendVarint(codepoint);
+    }
+    ++count_;
+}
+
+void KeystrokeRecorder::appendVarint(quint64 value) {
+    while (value >= 0x80) {
+        data_.append(static_cast<char>((value & 0x7F) | 0x80));
+        value >>= 7;
+    }
+    data_.append(static_cast<char>(value));
+}
+
+QVector<RecordedKeystroke> KeystrokeRecorder::decode(const QByteArray &data, const QString &targetText) {
+    QVector<RecordedKeystroke> result;
+    if (data.isEmpty() || static_cast<quint8>(data.at(0)) != kFormatVersion) {
+        return result;
+    }
+
+    const GraphemeIndex clusters(targetText);
+    int pos = 1;
+    int index = 0;
+    qint64 offsetMs = 0;
+    quint64 header = 0;
+    while (pos < data.size() && ReadVarint(data, &pos, &header)) {
+        RecordedKeystroke key;
+        key.kind = static_cast<KeystrokeKind>(header & kKindMask);
+        offsetMs += static_cast<qint64>(header >> kKindBits);
+        key.offsetMs = offsetMs;
+
+        switch (key.kind) {
+        case KeystrokeKind::Correct:
+            if (index < clusters.count()) {
+                key.codepoint = GraphemeIndex::firstCodepoint(
+                    QStringView(targetText).mid(clusters.start(index), clusters.length(index)));
+            }
+            ++index;
+            break;
+        case KeystrokeKind::Error: {
+            quint64 codepoint = 0;
+            if (!ReadVarint(data, &pos, &codepoint)) {
+                return result;
+            }
+            key.codepoint = static_cast<char32_t>(codepoint);
+            ++index;
+            break;
+        }
+        case KeystrokeKind::Backspace:
+            index = qMax(index - 1, 0);
+            break;
+        default:
+            return result;
+        }
+        result.append(key);
+    }
+    return result;
+}
@@ -0,0 +1,42 @@
+#ifndef KEYSTROKERECORDER_H
+#define KEYSTROKERECORDER_H
+
+#include <QByteArray>
+#include <QString>
+#include <QVector>
+#include "keystroketimeline.h"
+
+struct RecordedKeystroke {
+    qint64 offsetMs = 0;   // от первого нажатия
+    char32_t codepoint = 0;
+    KeystrokeKind kind = KeystrokeKind::Correct;
+};
+
+// Компактная запись нажатий сессии для хранения в БД.
+// Каждое нажатие — varint из (дельта времени в мс << 2 | вид нажатия);
+// код символа пишется отдельным varint только для ошибок, для верных нажатий
+// он восстанавливается из текста по номеру графемы. Обычное нажатие занимает 1–2 байта.
+class KeystrokeRecorder {
+public:
+    static constexpr quint8 kFormatVersion = 1;
+
+    KeystrokeRecorder();
+
+    void reset();
+    void append(qint64 timestampNs, char32_t codepoint, KeystrokeKind kind);
+
+    const QByteArray &data() const { return data_; }
+    int count() const { return count_; }
+
+    static QVector<RecordedKeystroke> decode(const QByteArray &data, const QString &targetText);
+
+private:
+    void appendVarint(quint64 value);
+
+    QByteArray data_;
+    int count_ = 0;
+    qint64 firstTimestampNs_ = 0;
+    qint64 lastOffsetMs_ = 0;
+};
+
+#endif // KEYSTROKERECORDER_H
@@ -0,0 +1,91 @@
+#include "keystroketimeline.h"
+
+namespace {
+constexpr double kNsInMinute = 60.0 * 1000.0 * 1000.0 * 1000.0;
+constexpr double kPercent = 100.0;
+
+int RoundUpToPowerOfTwo(int value) {
+    int result = 1;
+    while (result < value) {
+        result <<= 1;
+    }
+    return result;
+}
+}
+
+KeystrokeTimeline::KeystrokeTimeline(int capacity)
+    : buffer_(RoundUpToPowerOfTwo(qMax(capacity, 1))),
+      mask_(static_cast<quint32>(buffer_.size() - 1)) {}
+
+void KeystrokeTimeline::reset() {
+    total_ = 0;
+    firstTimestampNs_ = 0;
+    lastTimestampNs_ = 0;
+    typedChars_ = 0;
+    errorCount_ = 0;
+}
+
+void KeystrokeTimeline::record(qint64 timestampNs, char32_t codepoint, KeystrokeKind kind) {
+    if (total_ == 0) {
+        firstTimestampNs_ = timestampNs;
+    }
+    lastTimestampNs_ = timestampNs;
+
+    Keystroke &slot = buffer_[static_cast<quint32>(total_) & mask_];
+    slot.timestampNs = timestampNs;
+    slot.codepoint = codepoint;
+    slot.kind = kind;
+    ++total_;
+
+    switch (kind) {
+    case KeystrokeKind::Error:
+        ++errorCount_;
+        ++typedChars_;
+        break;
+    case KeystrokeKind::Correct:
+        ++typedChars_;
+        break;
+    case KeystrokeKind::Backspace:
+        --typedChars_;
+        break;
+    }
+}
+
+int KeystrokeTimeline::size() const {
+    return static_cast<int>(qMin<qint64>(total_, buffer_.size()));
+}
+
+const Keystroke &KeystrokeTimeline::at(int index) const {
+    const qint64 oldest = total_ - size();
+    return buffer_[static_cast<quint32>(oldest + index) & mask_];
+}
+
+const Keystroke &KeystrokeTimeline::last() const {
+    return buffer_[static_cast<quint32>(total_ - 1) & mask_];
+}
+
+double KeystrokeTimeline::elapsedMinutes(qint64 nowNs) const {
+    if (total_ == 0 || nowNs <= firstTimestampNs_) {
+        return 0.0;
+    }
+    return static_cast<double>(nowNs - firstTimestampNs_) / kNsInMinute;
+}
+
+double KeystrokeTimeline::rawWpm(qint64 nowNs) const {
+    const double minutes = elapsedMinutes(nowNs);
+    if (minutes <= 0.0) {
+        return 0.0;
+    }
+    return (static_cast<double>(typedChars_) / kWpmCoefficient) / minutes;
+}
+
+double KeystrokeTimeline::accuracy(int textLength) const {
+    if (textLength <= 0) {
+        return kPercent;
+    }
+    return qMax(kPercent - (static_cast<double>(errorCount_) / textLength * kPercent), 0.0);
+}
+
+double KeystrokeTimeline::wpm(qint64 nowNs, int textLength) const {
+    return rawWpm(nowNs) * accuracy(textLength) / kPercent;
+}
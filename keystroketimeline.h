@@ -0,0 +1,65 @@
+#ifndef KEYSTROKETIMELINE_H
+#define KEYSTROKETIMELINE_H
+
+#include <QtGlobal>
+#include <QVector>
+
+constexpr double kWpmCoefficient = 4.5;
+constexpr int kDefaultTimelineCapacity = 1 << 14;
+
+enum class KeystrokeKind : quint8 {
+    Correct,
+    Error,
+    Backspace
+};
+
+struct Keystroke {
+    qint64 timestampNs = 0;
+    char32_t codepoint = 0;
+    KeystrokeKind kind = KeystrokeKind::Correct;
+};
+
+// Лента нажатий с монотонными отметками времени в наносекундах.
+// Буфер выделяется один раз; при переполнении старые записи перезаписываются,
+// а счетчики для WPM и точности ведутся отдельно и не зависят от размера буфера.
+class KeystrokeTimeline {
+public:
+    explicit KeystrokeTimeline(int capacity = kDefaultTimelineCapacity);
+
+    void reset();
+    void record(qint64 timestampNs, char32_t codepoint, KeystrokeKind kind);
+
+    bool isEmpty() const { return total_ == 0; }
+    int size() const;
+    qint64 total() const { return total_; }
+    // 0 — самое старое нажатие из сохраненных в буфере
+    const Keystroke &at(int index) const;
+    const Keystroke &last() const;
+
+    qint64 firstTimestampNs() const { return firstTimestampNs_; }
+    qint64 lastTimestampNs() const { return lastTimestampNs_; }
+
+    int typedChars() const { return typedChars_; }
+    int errorCount() const { return errorCount_; }
+
+    double elapsedMinutes(qint64 nowNs) const;
+    double rawWpm(qint64 nowNs) const;
+    double accuracy(int textLength) const;
+    double wpm(qint64 nowNs, int textLength) const;
+
+    // Итоговые значения считаются по отметке последнего нажатия
+    double finalRawWpm() const { return rawWpm(lastTimestampNs_); }
+    double finalWpm(int textLength) const { return wpm(lastTimestampNs_, textLength); }
+
+private:
+    QVector<Keystroke> buffer_;
+    quint32 mask_;
+    qint64 total_ = 0;
+
+    qint64 firstTimestampNs_ = 0;
+    qint64 lastTimestampNs_ = 0;
+    int typedChars_ = 0;
+    int errorCount_ = 0;
+};
+
+#endif // KEYSTROKETIMELINE_H
@@ -0,0 +1,83 @@
+#include "latencyhistogram.h"
+#include <bit>
+
+namespace {
+constexpr double kNsInMs = 1e6;
+}
+
+void LatencyHistogram::reset() {
+    counts_.fill(0);
+    count_ = 0;
+    sumNs_ = 0;
+    maxNs_ = 0;
+}
+
+void LatencyHistogram::record(qint64 valueNs) {
+    valueNs = qMax<qint64>(valueNs, 0);
+    ++counts_[indexFor(valueNs)];
+    ++count_;
+    sumNs_ += valueNs;
+    maxNs_ = qMax(maxNs_, valueNs);
+}
+
+int LatencyHistogram::indexFor(qint64 valueNs) {
+    const quint64 value = static_cast<quint64>(valueNs);
+    if (value < quint64(kSubBuckets)) {
+        return int(value);
+    }
+    // Октава задается старшим битом, под-корзина — следующими kSubBucketBits битами
+    const int highBit = 63 - std::countl_zero(value);
+    const int octave = highBit - kSubBucketBits + 1;
+    const int subBucket = int((value >> (octave - 1)) & (kSubBuckets - 1));
+    return qMin(octave * kSubBuckets + subBucket, kOctaves * kSubBuckets - 1);
+}
+
+qint64 LatencyHistogram::valueAt(int index) {
+    const int octave = index / kSubBuckets;
+    const int subBucket = index % kSubBuckets;
+    if (octave == 0) {
+        return subBucket;
+    }
+    return (qint64(kSubBuckets + subBucket)) << (octave - 1);
+}
+
+qint64 LatencyHistogram::percentileNs(double percentile) const {
+    if (count_ == 0) {
+        return 0;
+    }
+    const double target = qBound(0.0, percentile, 100.0) / 100.0 * count_;
+    qint64 seen = 0;
+    for (int i = 0; i < int(counts_.size()); ++i) {
+        seen += counts_[i];
+        if (seen >= target && counts_[i] > 0) {
+            return qMin(valueAt(i), maxNs_);
+        }
+    }
+    return maxNs_;
+}
+
+void LatencyHistogram::writePercentiles(QTextStream &out) const {
+    out << "       Value     Percentile TotalCount 1/(1-Percentile)\n\n";
+
+    qint64 seen = 0;
+    for (int i = 0; i < int(counts_.size()); ++i) {
+        if (counts_[i] == 0) {
+            continue;
+        }
+        seen += counts_[i];
+        const double percentile = double(seen) / count_;
+        out << QString::number(qMin(valueAt(i), maxNs_) / kNsInMs, 'f', 3).rightJustified(12)
+            << QString::number(percentile, 'f', 12).rightJustified(15)
+            << QString::number(seen).rightJustified(11);
+        if (percentile < 1.0) {
+            out << QString::number(1.0 / (1.0 - percentile), 'f', 2).rightJustified(15);
+        }
+        out << '\n';
+    }
+
+    out << "#[Mean    = " << QString::number(meanNs() / kNsInMs, 'f', 3)
+        << ", Max = " << QString::number(maxNs_ / kNsInMs, 'f', 3) << "]\n"
+        << "#[Total count = " << count_
+        << ", p50 = " << QString::number(percentileNs(50) / kNsInMs, 'f', 3)
+        << ", p99 = " << QString::number(percentileNs(99) / kNsInMs, 'f', 3) << "]\n";
+}
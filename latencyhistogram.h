@@ -0,0 +1,38 @@
+#ifndef LATENCYHISTOGRAM_H
+#define LATENCYHISTOGRAM_H
+
+#include <QtGlobal>
+#include <QTextStream>
+#include <array>
+
+// Гистограмма задержек в духе HdrHistogram: 2^k-диапазоны, каждый поделен на
+// kSubBuckets равных частей, поэтому относительная погрешность не больше 1/kSubBuckets.
+// Запись — O(1) без выделений памяти, память фиксирована.
+class LatencyHistogram {
+public:
+    static constexpr int kSubBucketBits = 5;
+    static constexpr int kSubBuckets = 1 << kSubBucketBits;
+    static constexpr int kOctaves = 40;   // до ~2^44 нс
+
+    void reset();
+    void record(qint64 valueNs);
+
+    qint64 count() const { return count_; }
+    qint64 maxNs() const { return maxNs_; }
+    double meanNs() const { return count_ > 0 ? double(sumNs_) / count_ : 0.0; }
+    qint64 percentileNs(double percentile) const;
+
+    // Распределение по перцентилям в формате .hgrm (значения в миллисекундах)
+    void writePercentiles(QTextStream &out) const;
+
+private:
+    static int indexFor(qint64 valueNs);
+    static qint64 valueAt(int index);
+
+    std::array<quint32, kOctaves * kSubBuckets> counts_ {};
+    qint64 count_ = 0;
+    qint64 sumNs_ = 0;
+    qint64 maxNs_ = 0;
+};
+
+#endif // LATENCYHISTOGRAM_H
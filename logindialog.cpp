@@ -51,8 +51,8 @@ LoginDialog::LoginDialog(Database &db, QWidget *parent) :
     passwordEdit->setObjectName("inputField");
 
     // Иконка "глазик"
-    QIcon eyeOpenedIcon(QStringLiteral("/Users/hronov/Documents/Keyboard Trainer/icons/opened-eye.svg"));
-    QIcon eyeClosedIcon(QStringLiteral("/Users/hronov/Documents/Keyboard Trainer/icons/closed-eye.svg"));
+    QIcon eyeOpenedIcon(QStringLiteral(":/icons/opened-eye.svg"));
+    QIcon eyeClosedIcon(QStringLiteral(":/icons/closed-eye.svg"));
 
     QAction *togglePasswordAction = passwordEdit->addAction(eyeClosedIcon, QLineEdit::TrailingPosition);
     togglePasswordAction->setCheckable(true);
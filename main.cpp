@@ -1,5 +1,7 @@
 #include <QApplication>
 #include <QPushButton>
+#include <QThreadPool>
+#include <memory>
 #include "window.h"
 
 
@@ -7,11 +9,19 @@ int main(int argc, char* argv[]) {
     Database db;
     curl_global_init(CURL_GLOBAL_DEFAULT);
     QApplication a(argc, argv);
-    auto* window = new Window(db);
+    // База нужна до входа: кэш ответов AI работает и без учетной записи.
+    // Если открыть не удалось, вход попробует еще раз
+    db.initDatabase();
+    auto window = std::make_unique<Window>(db);
     window->setWindowTitle("Keyboard Trainer");
     window->resize(kWindowSize, kWindowSize);
     window->show();
+    const int code = a.exec();
+
+    // Окно отменяет запросы AI; curl в рабочих потоках видит флаг отмены и выходит.
+    // Только после этого можно освобождать curl
+    window.reset();
+    QThreadPool::globalInstance()->waitForDone();
     curl_global_cleanup();
-    return a.exec();
+    return code;
 }
-
@@ -0,0 +1,71 @@
+#include "ngramindex.h"
+#include <algorithm>
+#include <utility>
+
+void NgramIndex::build(const WordPack &words) {
+    clear();
+
+    // Пары (ключ, слово) сортируются и сворачиваются в CSR за один проход
+    QVector<std::pair<quint64, quint32>> pairs;
+    QVector<quint64> wordKeys;
+    for (int id = 0; id < words.count(); ++id) {
+        const QString word = words.word(id);
+        wordKeys.clear();
+
+        char32_t previous = 0;
+        for (auto it = word.cbegin(); it != word.cend(); ++it) {
+            char32_t c = it->unicode();
+            if (it->isHighSurrogate() && it + 1 != word.cend() && (it + 1)->isLowSurrogate()) {
+                c = QChar::surrogateToUcs4(*it, *(it + 1));
+                ++it;
+            }
+            wordKeys.append(charKey(c));
+            if (previous != 0) {
+                wordKeys.append(bigramKey(previous, c));
+            }
+            previous = c;
+        }
+
+        // Слово входит в список ключа один раз, сколько бы раз ключ в нем ни встречался
+        std::sort(wordKeys.begin(), wordKeys.end());
+        wordKeys.erase(std::unique(wordKeys.begin(), wordKeys.end()), wordKeys.end());
+        for (quint64 key : wordKeys) {
+            pairs.append({key, quint32(id)});
+        }
+    }
+    std::sort(pairs.begin(), pairs.end());
+
+    postings_.reserve(pairs.size());
+    for (const auto &[key, id] : pairs) {
+        if (keys_.isEmpty() || keys_.last() != key) {
+            keys_.append(key);
+            starts_.append(quint32(postings_.size()));
+        }
+        postings_.append(id);
+    }
+    starts_.append(quint32(postings_.size()));
+
+    keys_.squeeze();
+    starts_.squeeze();
+}
+
+void NgramIndex::clear() {
+    keys_.clear();
+    starts_.clear();
+    postings_.clear();
+}
+
+NgramIndex::Postings NgramIndex::find(quint64 key) const {
+    const auto it = std::lower_bound(keys_.cbegin(), keys_.cend(), key);
+    if (it == keys_.cend() || *it != key) {
+        return {};
+    }
+    const qsizetype slot = it - keys_.cbegin();
+    return { postings_.constData() + starts_[slot], postings_.constData() + starts_[slot + 1] };
+}
+
+qint64 NgramIndex::memoryBytes() const {
+    return keys_.capacity() * qint64(sizeof(quint64))
+        + starts_.capacity() * qint64(sizeof(quint32))
+        + postings_.capacity() * qint64(sizeof(quint32));
+}
@@ -0,0 +1,44 @@
+#ifndef NGRAMINDEX_H
+#define NGRAMINDEX_H
+
+#include <QVector>
+#include "wordpack.h"
+
+struct NgramWeight {
+    quint64 key;
+    double weight;
+};
+
+// Обратный индекс набора слов: символ или биграмма -> номера слов, где они встречаются.
+// Хранится в CSR-виде: отсортированные ключи, начала списков и один общий массив
+// номеров, поэтому поиск — бинарный по ключам, а список слов — непрерывный отрезок.
+// Ключ биграммы — (первый << 32) | второй, символа — (0 << 32) | символ,
+// как в KeyLatencyStats::bigramKey.
+class NgramIndex {
+public:
+    static quint64 charKey(char32_t c) { return quint64(c); }
+    static quint64 bigramKey(char32_t first, char32_t second) { return (quint64(first) << 32) | second; }
+
+    void build(const WordPack &words);
+    void clear();
+
+    bool isEmpty() const { return keys_.isEmpty(); }
+    int keyCount() const { return keys_.size(); }
+
+    // Номера слов, содержащих ключ; пустой отрезок, если таких нет
+    struct Postings {
+        const quint32 *begin = nullptr;
+        const quint32 *end = nullptr;
+        int size() const { return int(end - begin); }
+    };
+    Postings find(quint64 key) const;
+
+    qint64 memoryBytes() const;
+
+private:
+    QVector<quint64> keys_;
+    QVector<quint32> starts_;
+    QVector<quint32> postings_;
+};
+
+#endif // NGRAMINDEX_H
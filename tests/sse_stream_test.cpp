@@ -0,0 +1,118 @@
+// Разбор потокового ответа chat/completions: тело подается в приемник curl
+// кусками произвольной длины, в том числе с разрывом посреди строки и CRLF.
+// Живой поток того же формата отдает tools/mock_sse_server.py.
+
+#include "AI json-request/api.h"
+
+namespace {
+int failures = 0;
+
+void Check(bool condition, const std::string& what) {
+    if (!condition) {
+        std::cerr << "FAIL: " << what << std::endl;
+        ++failures;
+    }
+}
+
+std::string Event(const std::string& json) {
+    return "data: " + json + "\r\n\r\n";
+}
+
+const std::string kStream =
+    ": keep-alive comment\r\n\r\n"
+    + Event(R"({"choices":[{"index":0,"delta":{"role":"assistant"}}]})")
+    + Event(R"({"choices":[{"index":0,"delta":{"content":"Привет"}}]})")
+    + Event(R"({"choices":[]})")
+    + Event(R"({"choices":[{"index":0,"delta":{"content":", мир."}}]})")
+    + Event(R"({"choices":[{"index":0,"delta":{"content":" Ещё"}}]})")
+    + Event(R"({"choices":[{"index":0,"delta":{},"finish_reason":"stop"}]})")
+    + "data: [DONE]\r\n\r\n"
+    + Event(R"({"choices":[{"index":0,"delta":{"content":"после конца"}}]})");
+
+const std::string kText = "Привет, мир. Ещё";
+
+// Подает body кусками по chunk байт; возвращает собранные фрагменты
+std::string Feed(SseStreamState& state, const std::string& body, size_t chunk, std::vector<std::string>* deltas) {
+    state.onDelta = [deltas](const std::string& delta) { deltas->push_back(delta); };
+    for (size_t offset = 0; offset < body.size(); offset += chunk) {
+        std::string part = body.substr(offset, chunk);
+        const size_t taken = StreamWriteCallback(part.data(), 1, part.size(), &state);
+        if (taken != part.size()) {
+            break;
+        }
+    }
+    return FinishStream(state);
+}
+
+void TestSplitAtEveryPosition() {
+    for (size_t chunk = 1; chunk <= kStream.size(); ++chunk) {
+        SseStreamState state;
+        std::vector<std::string> deltas;
+        const std::string text = Feed(state, kStream, chunk, &deltas);
+        const std::string label = "chunk " + std::to_string(chunk);
+        Check(text == kText, label + ": text");
+        Check(deltas.size() == 3, label + ": delta count");
+        Check(state.done, label + ": [DONE] seen");
+    }
+}
+
+void TestLastLineWithoutNewline() {
+    SseStreamState state;
+    std::vector<std::string> deltas;
+    const std::string body = Event(R"({"choices":[{"delta":{"content":"a"}}]})")
+        + Event(R"({"choices":[{"delta":{"content":"b"}}]})")
+        + "data: [DONE]";
+    Check(Feed(state, body, 7, &deltas) == "ab", "trailing line without newline");
+}
+
+void TestTruncatedStream() {
+    SseStreamState state;
+    std::vector<std::string> deltas;
+    const std::string body = Event(R"({"choices":[{"delta":{"content":"a"}}]})");
+    bool threw = false;
+    try {
+        Feed(state, body, 4, &deltas);
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    Check(threw, "stream closed before [DONE] is an error");
+    Check(deltas.size() == 1, "deltas before the break are delivered");
+}
+
+void TestPlainJsonFallback() {
+    SseStreamState state;
+    std::vector<std::string> deltas;
+    const std::string body = "{\n  \"choices\": [{\"message\": {\"content\": \"целиком\"}}]\n}\n";
+    Check(Feed(state, body, 5, &deltas) == "целиком", "plain JSON body");
+    Check(deltas.size() == 1 && deltas[0] == "целиком", "plain JSON delivered as one delta");
+}
+
+void TestMalformedEventAborts() {
+    SseStreamState state;
+    std::string body = "data: {\"choices\": [\n\n";
+    Check(StreamWriteCallback(body.data(), 1, body.size(), &state) == 0, "malformed event aborts transfer");
+    bool threw = false;
+    try {
+        FinishStream(state);
+    } catch (const nlohmann::json::exception&) {
+        threw = true;
+    }
+    Check(threw, "malformed event rethrown as json exception");
+}
+}
+
+int main() {
+    try {
+        TestSplitAtEveryPosition();
+        TestLastLineWithoutNewline();
+        TestTruncatedStream();
+        TestPlainJsonFallback();
+        TestMalformedEventAborts();
+    } catch (const std::exception& error) {
+        Check(false, std::string("unexpected exception: ") + error.what());
+    }
+    if (failures == 0) {
+        std::cout << "sse_stream_test: OK" << std::endl;
+    }
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,198 @@
+#include "textpipeline.h"
+#include <limits>
+
+namespace {
+constexpr int kMinSentenceWords = 3;
+constexpr double kSentenceEndChance = 0.15;
+constexpr double kQuestionChance = 0.15;
+constexpr double kExclamationChance = 0.05;
+constexpr double kCommaChance = 0.08;
+constexpr double kNumberChance = 0.1;
+constexpr quint32 kMaxNumber = 10000;
+
+bool EndsSentence(QChar c) {
+    switch (c.unicode()) {
+    case '.': case '!': case '?':
+    case 0x2026:    // …
+    case 0x3002:    // 。
+    case 0xFF01:    // ！
+    case 0xFF1F:    // ？
+    case 0x061F:    // ؟
+    case 0x0589:    // ։
+        return true;
+    default:
+        return false;
+    }
+}
+
+struct Marks {
+    QStringView comma;
+    QStringView period;
+    QStringView question;
+    QStringView exclamation;
+};
+
+Marks MarksFor(PunctuationStyle style) {
+    switch (style) {
+    case PunctuationStyle::Arabic:
+        return { u"،", u".", u"؟", u"!" };
+    case PunctuationStyle::Armenian:
+        return { u",", u"։", u"?", u"!" };
+    case PunctuationStyle::Cjk:
+        return { u"，", u"。", u"？", u"！" };
+    case PunctuationStyle::Latin:
+    case PunctuationStyle::Spanish:
+        break;
+    }
+    return { u",", u".", u"?", u"!" };
+}
+}
+
+PunctuationStyle PunctuationStyleFor(const QString &language) {
+    // Имя набора слов (spanish_10k) или язык генерации AI (Испанский)
+    const QString name = language.toLower();
+    if (name.startsWith("spanish") || name.startsWith("испан")) {
+        return PunctuationStyle::Spanish;
+    }
+    if (name.startsWith("arabic") || name.startsWith("persian") || name.startsWith("urdu")
+        || name.startsWith("араб") || name.startsWith("персид") || name.startsWith("урду")) {
+        return PunctuationStyle::Arabic;
+    }
+    if (name.startsWith("armenian") || name.startsWith("армян")) {
+        return PunctuationStyle::Armenian;
+    }
+    if (name.startsWith("chinese") || name.startsWith("japanese")
+        || name.startsWith("китай") || name.startsWith("япон")) {
+        return PunctuationStyle::Cjk;
+    }
+    return PunctuationStyle::Latin;
+}
+
+void CapitalizeTransform::apply(QString &word, TransformContext &context) {
+    if (!context.sentenceStart || word.isEmpty()) {
+        return;
+    }
+    QChar *data = word.data();
+    if (data[0].isHighSurrogate() && word.size() > 1) {
+        const char32_t upper = QChar::toUpper(QChar::surrogateToUcs4(data[0], data[1]));
+        data[0] = QChar::highSurrogate(upper);
+        data[1] = QChar::lowSurrogate(upper);
+    } else {
+        data[0] = data[0].toUpper();
+    }
+}
+
+void PunctuationTransform::apply(QString &word, TransformContext &context) {
+    if (word.isEmpty()) {
+        return;
+    }
+    QRandomGenerator &rng = *context.rng;
+    const Marks marks = MarksFor(style_);
+
+    // Слово уже с пунктуацией — только следим за границами предложений
+    if (word.back().isPunct()) {
+        context.sentenceStart = EndsSentence(word.back());
+        context.wordsInSentence = context.sentenceStart ? 0 : context.wordsInSentence + 1;
+        return;
+    }
+
+    if (context.sentenceStart) {
+        context.question = rng.generateDouble() < kQuestionChance;
+        if (context.question && style_ == PunctuationStyle::Spanish) {
+            word.prepend(u'¿');
+        }
+    }
+    ++context.wordsInSentence;
+
+    if (context.wordsInSentence >= kMinSentenceWords && rng.generateDouble() < kSentenceEndChance) {
+        if (context.question) {
+            word += marks.question;
+        } else if (rng.generateDouble() < kExclamationChance) {
+            word += marks.exclamation;
+        } else {
+            word += marks.period;
+        }
+        context.sentenceStart = true;
+        context.wordsInSentence = 0;
+        return;
+    }
+
+    if (context.wordsInSentence > 1 && rng.generateDouble() < kCommaChance) {
+        word += marks.comma;
+    }
+    context.sentenceStart = false;
+}
+
+void NumbersTransform::apply(QString &word, TransformContext &context) {
+    QRandomGenerator &rng = *context.rng;
+    if (rng.generateDouble() >= kNumberChance) {
+        return;
+    }
+    // Число встает перед словом, чтобы не ломать оформление предложения
+    word.prepend(u' ');
+    word.prepend(QString::number(rng.bounded(1u, kMaxNumber)));
+}
+
+bool TextWordSource::next(QString &word, QStringView *separator) {
+    const qsizetype separatorStart = position_;
+    while (position_ < text_.size() && text_[position_].isSpace()) {
+        ++position_;
+    }
+    if (position_ == text_.size()) {
+        return false;
+    }
+    *separator = text_.sliced(separatorStart, position_ - separatorStart);
+
+    const qsizetype wordStart = position_;
+    while (position_ < text_.size() && !text_[position_].isSpace()) {
+        ++position_;
+    }
+    word.append(text_.sliced(wordStart, position_ - wordStart));
+    return true;
+}
+
+bool PackWordSource::next(QString &word, QStringView *separator) {
+    if (words_.isEmpty()) {
+        return false;
+    }
+    const int index = sampler_ != nullptr && !sampler_->isEmpty()
+        ? sampler_->draw(rng_)
+        : int(rng_.bounded(quint32(words_.count())));
+    words_.appendWord(index, word);
+    *separator = u" ";
+    return true;
+}
+
+int TextPipeline::run(WordSource &source, QString &out, int maxWords, QRandomGenerator &rng) {
+    context_.rng = &rng;
+    int words = 0;
+    QStringView separator;
+    while (words < maxWords) {
+        // resize(0) сохраняет емкость буфера, clear() бы ее освободил
+        word_.resize(0);
+        if (!source.next(word_, &separator)) {
+            break;
+        }
+        for (const auto &stage : stages_) {
+            stage->apply(word_, context_);
+        }
+
+        // Первое слово текста идет без отступа
+        if (!out.isEmpty()) {
+            out += separator.isEmpty() ? QStringView(u" ") : separator;
+        }
+        out += word_;
+        ++words;
+    }
+    return words;
+}
+
+QString TextPipeline::transform(QStringView text, QRandomGenerator &rng) {
+    resetContext();
+    QString out;
+    // Стадии удлиняют текст незначительно; запас избавляет от перевыделений
+    out.reserve(text.size() + text.size() / 4);
+    TextWordSource source(text);
+    run(source, out, std::numeric_limits<int>::max(), rng);
+    return out;
+}
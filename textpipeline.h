@@ -0,0 +1,118 @@
+#ifndef TEXTPIPELINE_H
+#define TEXTPIPELINE_H
+
+#include <QRandomGenerator>
+#include <QString>
+#include <QStringView>
+#include <memory>
+#include <vector>
+#include "wordpack.h"
+#include "wordsampler.h"
+
+// Оформление предложений для разных письменностей
+enum class PunctuationStyle {
+    Latin,
+    Spanish,    // вопрос открывается знаком ¿
+    Arabic,     // ، и ؟
+    Armenian,   // точка — ։
+    Cjk,        // полноширинные ，。？！
+};
+
+PunctuationStyle PunctuationStyleFor(const QString &language);
+
+// Состояние, которое стадии передают от слова к слову
+struct TransformContext {
+    QRandomGenerator *rng = nullptr;
+    bool sentenceStart = true;
+    int wordsInSentence = 0;
+    bool question = false;
+};
+
+// Стадия конвейера меняет одно слово на месте, не видя остального текста
+class TextTransform {
+public:
+    virtual ~TextTransform() = default;
+    virtual void apply(QString &word, TransformContext &context) = 0;
+};
+
+// Заглавная буква в начале предложения
+class CapitalizeTransform : public TextTransform {
+public:
+    void apply(QString &word, TransformContext &context) override;
+};
+
+// Запятые и концы предложений; слово, уже оканчивающееся знаком, только отмечает границу
+class PunctuationTransform : public TextTransform {
+public:
+    explicit PunctuationTransform(PunctuationStyle style) : style_(style) {}
+    void apply(QString &word, TransformContext &context) override;
+
+private:
+    PunctuationStyle style_;
+};
+
+// Время от времени вставляет число перед словом
+class NumbersTransform : public TextTransform {
+public:
+    void apply(QString &word, TransformContext &context) override;
+};
+
+// Источник слов для конвейера
+class WordSource {
+public:
+    virtual ~WordSource() = default;
+    // Дописывает следующее слово в word; separator — пробелы перед ним в исходном тексте.
+    // false, если слова закончились
+    virtual bool next(QString &word, QStringView *separator) = 0;
+};
+
+// Слова готового текста (файл, ответ AI, страница книги); разделители сохраняются
+class TextWordSource : public WordSource {
+public:
+    explicit TextWordSource(QStringView text) : text_(text) {}
+    bool next(QString &word, QStringView *separator) override;
+
+private:
+    QStringView text_;
+    qsizetype position_ = 0;
+};
+
+// Бесконечный поток слов набора: равновероятно или по частотам sampler
+class PackWordSource : public WordSource {
+public:
+    PackWordSource(const WordPack &words, const WordSampler *sampler, QRandomGenerator &rng)
+        : words_(words), sampler_(sampler), rng_(rng) {}
+    bool next(QString &word, QStringView *separator) override;
+
+private:
+    const WordPack &words_;
+    const WordSampler *sampler_;
+    QRandomGenerator &rng_;
+};
+
+// Конвейер преобразований. Слова идут по одному через все стадии в одном
+// переиспользуемом буфере и сразу дописываются в результат: текст копируется
+// один раз, сколько бы стадий ни было включено.
+class TextPipeline {
+public:
+    void addStage(std::unique_ptr<TextTransform> stage) { stages_.push_back(std::move(stage)); }
+    void clear() { stages_.clear(); }
+    bool isEmpty() const { return stages_.empty(); }
+
+    // Начинает новый текст: следующее слово — начало предложения
+    void resetContext() { context_ = TransformContext(); }
+
+    // Дописывает в out до maxWords слов из source; возвращает, сколько дописано.
+    // Состояние между вызовами сохраняется, так что текст можно наращивать порциями
+    int run(WordSource &source, QString &out, int maxWords, QRandomGenerator &rng);
+
+    // Весь text через конвейер с чистого состояния
+    QString transform(QStringView text, QRandomGenerator &rng);
+
+private:
+    std::vector<std::unique_ptr<TextTransform>> stages_;
+    TransformContext context_;
+    QString word_;
+};
+
+#endif // TEXTPIPELINE_H
@@ -0,0 +1,100 @@
+#!/usr/bin/env python3
+"""Локальный mock chat/completions для проверки потоковой генерации без сети.
+
+Запуск (разбор того же формата проверяет tests/sse_stream_test.cpp):
+    python3 tools/mock_sse_server.py --port 8765 --delay 0.05
+    KEYBOARD_TRAINER_AI_ENDPOINT=http://127.0.0.1:8765/v1/chat/completions ./Keyboard_Trainer
+
+На запрос с "stream": true отвечает server-sent events в формате OpenAI
+(по слову на событие, затем data: [DONE]); без него — обычным JSON целиком.
+--fail-after N обрывает поток после N событий, чтобы проверить обрыв сети.
+"""
+
+import argparse
+import json
+import time
+from http.server import BaseHTTPRequestHandler, ThreadingHTTPServer
+
+TEXT = (
+    "Variables in C++ must be declared before they are used. "
+    "Prefer const references for large arguments to avoid copies. "
+    "In Python, list comprehensions are often clearer than explicit loops. "
+    "Measure before optimizing, because intuition about performance is often wrong. "
+    "Small functions with clear names make code easier to test and to read."
+)
+
+
+def chunk(delta, finish_reason=None):
+    return {
+        "id": "mock",
+        "object": "chat.completion.chunk",
+        "choices": [{"index": 0, "delta": delta, "finish_reason": finish_reason}],
+    }
+
+
+class Handler(BaseHTTPRequestHandler):
+    protocol_version = "HTTP/1.1"
+
+    def do_POST(self):
+        length = int(self.headers.get("Content-Length", 0))
+        body = self.rfile.read(length)
+        try:
+            stream = bool(json.loads(body).get("stream"))
+        except ValueError:
+            # Приложение не экранирует запрос; разбор тела для mock не важен
+            stream = b'"stream": true' in body
+
+        if not stream:
+            payload = json.dumps({
+                "choices": [{"index": 0, "message": {"role": "assistant", "content": TEXT}}],
+            }).encode()
+            self.send_response(200)
+            self.send_header("Content-Type", "application/json")
+            self.send_header("Content-Length", str(len(payload)))
+            self.end_headers()
+            self.wfile.write(payload)
+            return
+
+        self.send_response(200)
+        self.send_header("Content-Type", "text/event-stream")
+        self.send_header("Cache-Control", "no-cache")
+        self.send_header("Connection", "close")
+        self.end_headers()
+
+        events = [chunk({"role": "assistant"})]
+        words = TEXT.split(" ")
+        events += [chunk({"content": word if i == 0 else " " + word}) for i, word in enumerate(words)]
+        events.append(chunk({}, "stop"))
+
+        for sent, event in enumerate(events):
+            if self.server.fail_after is not None and sent >= self.server.fail_after:
+                self.close_connection = True
+                return
+            self.wfile.write(b"data: " + json.dumps(event).encode() + b"\n\n")
+            self.wfile.flush()
+            time.sleep(self.server.delay)
+        self.wfile.write(b"data: [DONE]\n\n")
+        self.wfile.flush()
+        self.close_connection = True
+
+    def log_message(self, fmt, *args):
+        pass
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--host", default="127.0.0.1")
+    parser.add_argument("--port", type=int, default=8765)
+    parser.add_argument("--delay", type=float, default=0.05, help="пауза между событиями, с")
+    parser.add_argument("--fail-after", type=int, default=None, help="оборвать поток после N событий")
+    args = parser.parse_args()
+
+    server = ThreadingHTTPServer((args.host, args.port), Handler)
+    server.delay = args.delay
+    server.fail_after = args.fail_after
+    print(f"mock SSE: http://{args.host}:{args.port}/v1/chat/completions")
+    server.serve_forever()
+
+
+if __name__ == "__main__":
+    main()
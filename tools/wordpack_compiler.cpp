@@ -0,0 +1,37 @@
+// Компилирует JSON-набор слов в .kwp:
+//   wordpack_compiler <input.json> <output.kwp>
+#include <QCoreApplication>
+#include <QFile>
+#include <QTextStream>
+#include "../wordpack.h"
+
+int main(int argc, char* argv[]) {
+    QCoreApplication app(argc, argv);
+    QTextStream err(stderr);
+
+    const QStringList args = app.arguments();
+    if (args.size() != 3) {
+        err << "usage: wordpack_compiler <input.json> <output.kwp>\n";
+        return 2;
+    }
+
+    QFile input(args.at(1));
+    if (!input.open(QIODevice::ReadOnly)) {
+        err << "cannot open " << args.at(1) << '\n';
+        return 1;
+    }
+
+    QString error;
+    const QByteArray image = WordPack::compileJson(input.readAll(), &error);
+    if (image.isEmpty()) {
+        err << args.at(1) << ": " << error << '\n';
+        return 1;
+    }
+
+    QFile output(args.at(2));
+    if (!output.open(QIODevice::WriteOnly) || output.write(image) != image.size()) {
+        err << "cannot write " << args.at(2) << '\n';
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,78 @@
+#include "typingsession.h"
+
+void TypingSession::reset(const QString &targetText) {
+    targetText_ = targetText;
+    clusters_.build(targetText_);
+    states_.fill(CharState::Pending, clusters_.count());
+    currentIndex_ = 0;
+    retired_ = 0;
+    timeline_.reset();
+    recorder_.reset();
+}
+
+void TypingSession::append(const QString &text) {
+    targetText_ += text;
+    clusters_.append(text);
+    states_.insert(states_.size(), clusters_.count() - states_.size(), CharState::Pending);
+}
+
+void TypingSession::retire(int clusters) {
+    clusters = qMin(clusters, currentIndex_);
+    if (clusters <= 0) {
+        return;
+    }
+    targetText_.remove(0, clusters_.start(clusters));
+    clusters_.removeFront(clusters);
+    states_.remove(0, clusters);
+    currentIndex_ -= clusters;
+    retired_ += clusters;
+}
+
+QStringView TypingSession::clusterAt(int index) const {
+    return QStringView(targetText_).mid(clusters_.start(index), clusters_.length(index));
+}
+
+int TypingSession::type(const QString &text, qint64 timestampNs) {
+    // Одиночный символ с клавиатуры — обычный случай, сегментация не нужна
+    if (text.length() == 1) {
+        return typeCluster(text, timestampNs) ? 1 : 0;
+    }
+
+    const GraphemeIndex typed(text);
+    int consumed = 0;
+    for (int i = 0; i < typed.count(); ++i) {
+        if (!typeCluster(QStringView(text).mid(typed.start(i), typed.length(i)), timestampNs)) {
+            break;
+        }
+        ++consumed;
+    }
+    return consumed;
+}
+
+bool TypingSession::typeCluster(QStringView typed, qint64 timestampNs) {
+    if (currentIndex_ >= length()) {
+        return false;
+    }
+
+    const bool correct = typed == clusterAt(currentIndex_);
+    const char32_t codepoint = GraphemeIndex::firstCodepoint(typed);
+    const KeystrokeKind kind = correct ? KeystrokeKind::Correct : KeystrokeKind::Error;
+
+    states_[currentIndex_] = correct ? CharState::Correct : CharState::Error;
+    timeline_.record(timestampNs, codepoint, kind);
+    recorder_.append(timestampNs, codepoint, kind);
+    ++currentIndex_;
+    return true;
+}
+
+bool TypingSession::backspace(qint64 timestampNs) {
+    if (currentIndex_ == 0) {
+        return false;
+    }
+
+    --currentIndex_;
+    states_[currentIndex_] = CharState::Pending;
+    timeline_.record(timestampNs, 0, KeystrokeKind::Backspace);
+    recorder_.append(timestampNs, 0, KeystrokeKind::Backspace);
+    return true;
+}
@@ -0,0 +1,80 @@
+#ifndef TYPINGSESSION_H
+#define TYPINGSESSION_H
+
+#include <QString>
+#include <QStringView>
+#include <QVector>
+#include "graphemeindex.h"
+#include "keystrokerecorder.h"
+#include "keystroketimeline.h"
+
+enum class CharState : quint8 {
+    Pending,
+    Correct,
+    Error
+};
+
+// Состояние одного прохода по тексту и подсчет результата.
+// Не зависит от Qt Widgets: время нажатий передается снаружи, поэтому
+// сессию можно прогонять без дисплея записанными или синтетическими нажатиями.
+// Все индексы — номера графем, а не UTF-16 позиции.
+class TypingSession {
+public:
+    TypingSession() = default;
+
+    void reset(const QString &targetText);
+
+    // Бесконечный текст (режим на время): сессия не завершается по концу текста,
+    // а точность считается по набранному, а не по длине текста
+    void setOpenEnded(bool openEnded) { openEnded_ = openEnded; }
+    bool isOpenEnded() const { return openEnded_; }
+    // Дописывает текст в конец
+    void append(const QString &text);
+    // Убирает из начала уже набранные графемы (не больше currentIndex)
+    void retire(int clusters);
+    int retiredCount() const { return retired_; }
+
+    // Набирает графемы из text (например, строку IME целиком); возвращает число набранных
+    int type(const QString &text, qint64 timestampNs);
+    // Возвращает false, если стирать нечего
+    bool backspace(qint64 timestampNs);
+
+    const QString &targetText() const { return targetText_; }
+    int length() const { return clusters_.count(); }
+    int currentIndex() const { return currentIndex_; }
+    CharState stateAt(int index) const { return states_[index]; }
+
+    int clusterStart(int index) const { return clusters_.start(index); }
+    int clusterLength(int index) const { return clusters_.length(index); }
+    int clusterIndexAt(int position) const { return clusters_.clusterAt(position); }
+    QStringView clusterAt(int index) const;
+    char32_t codepointAt(int index) const { return GraphemeIndex::firstCodepoint(clusterAt(index)); }
+
+    bool isStarted() const { return !timeline_.isEmpty(); }
+    bool isFinished() const { return !openEnded_ && length() > 0 && currentIndex_ == length(); }
+
+    int errorCount() const { return timeline_.errorCount(); }
+    double rawWpm(qint64 nowNs) const { return timeline_.rawWpm(nowNs); }
+    double accuracy() const { return timeline_.accuracy(scoredLength()); }
+    double wpm(qint64 nowNs) const { return timeline_.wpm(nowNs, scoredLength()); }
+    double finalRawWpm() const { return timeline_.finalRawWpm(); }
+    double finalWpm() const { return timeline_.finalWpm(scoredLength()); }
+
+    const KeystrokeTimeline &timeline() const { return timeline_; }
+    const KeystrokeRecorder &recorder() const { return recorder_; }
+
+private:
+    bool typeCluster(QStringView typed, qint64 timestampNs);
+    int scoredLength() const { return openEnded_ ? qMax(1, retired_ + currentIndex_) : length(); }
+
+    QString targetText_;
+    GraphemeIndex clusters_;
+    QVector<CharState> states_;
+    int currentIndex_ = 0;
+    bool openEnded_ = false;
+    int retired_ = 0;
+    KeystrokeTimeline timeline_;
+    KeystrokeRecorder recorder_;
+};
+
+#endif // TYPINGSESSION_H
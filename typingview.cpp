@@ -0,0 +1,304 @@
+#include "typingview.h"
+#include <QFontMetricsF>
+#include <QPaintEvent>
+#include <QResizeEvent>
+#include <QScreen>
+#include <QPainter>
+#include <QTextOption>
+#include <QtMath>
+#include <algorithm>
+
+namespace {
+constexpr qreal kCaretMinWidth = 2.0;
+constexpr qreal kUnderlineOffset = 2.0;
+const QColor kCorrectColor("green");
+const QColor kErrorColor("red");
+const QColor kCaretBlockColor(0, 0, 0, 102);
+const QColor kGhostCaretColor(136, 192, 208, 180);
+constexpr qreal kGhostCaretWidth = 2.0;
+}
+
+TypingView::TypingView(QWidget *parent) : QWidget(parent), font_(font()) {
+    setFocusPolicy(Qt::NoFocus);
+    layout_.setCacheEnabled(true);
+    connect(&scheduler_, &FrameScheduler::frame, this, &TypingView::flushDirty);
+}
+
+void TypingView::setTargetText(const QString &text) {
+    targetText_ = text;
+    states_.fill(CharState::Pending, text.length());
+    caretIndex_ = 0;
+    ghostIndex_ = -1;
+    relayout();
+}
+
+QString TypingView::targetText() const {
+    return targetText_;
+}
+
+void TypingView::clearText() {
+    setTargetText(QString());
+}
+
+void TypingView::scrollText(int retiredLength, const QString &appended) {
+    retiredLength = qBound(0, retiredLength, int(targetText_.length()));
+    targetText_.remove(0, retiredLength);
+    targetText_ += appended;
+    states_.remove(0, retiredLength);
+    states_.insert(states_.size(), appended.length(), CharState::Pending);
+    caretIndex_ = qMax(0, caretIndex_ - retiredLength);
+    ghostIndex_ = -1;
+    relayout();
+}
+
+void TypingView::setCharState(int position, int length, CharState state) {
+    if (position < 0 || position + length > states_.size() || states_[position] == state) {
+        return;
+    }
+    std::fill(states_.begin() + position, states_.begin() + position + length, state);
+    updateChar(position);
+}
+
+void TypingView::setCaret(int position) {
+    if (position == caretIndex_) {
+        return;
+    }
+    const int previous = caretIndex_;
+    caretIndex_ = position;
+    updateChar(previous);
+    updateChar(caretIndex_);
+}
+
+void TypingView::setGhostCaret(int position) {
+    if (position == ghostIndex_) {
+        return;
+    }
+    const int previous = ghostIndex_;
+    ghostIndex_ = position;
+    if (previous >= 0) {
+        updateChar(previous);
+    }
+    if (ghostIndex_ >= 0) {
+        updateChar(ghostIndex_);
+    }
+}
+
+void TypingView::setTextStyle(const QFont &font, const QColor &color, int lineHeight, const QString &caretStyle) {
+    font_ = font;
+    textColor_ = color;
+    lineHeight_ = lineHeight;
+    caretStyle_ = caretStyle;
+    relayout();
+}
+
+QRect TypingView::caretRect() const {
+    return charRect(caretIndex_).toAlignedRect();
+}
+
+QSize TypingView::sizeHint() const {
+    return QSize(width(), contentHeight_);
+}
+
+void TypingView::resizeEvent(QResizeEvent *event) {
+    QWidget::resizeEvent(event);
+    // Перенос строк зависит только от ширины
+    if (event->oldSize().width() != width()) {
+        relayout();
+    }
+}
+
+void TypingView::showEvent(QShowEvent *event) {
+    QWidget::showEvent(event);
+    if (screen() != nullptr) {
+        scheduler_.setRefreshRate(screen()->refreshRate());
+    }
+}
+
+void TypingView::relayout() {
+    // Переводы строк в QTextLayout задаются LineSeparator; длина текста не меняется,
+    // поэтому индексы символов совпадают с индексами targetText_
+    QString layoutText = targetText_;
+    layoutText.replace('\n', QChar::LineSeparator);
+
+    QTextOption option(Qt::AlignHCenter);
+    option.setWrapMode(QTextOption::WordWrap);
+
+    layout_.clearLayout();
+    layout_.setText(layoutText);
+    layout_.setFont(font_);
+    layout_.setTextOption(option);
+
+    const QFontMetricsF metrics(font_);
+    lineSpacing_ = qMax<qreal>(lineHeight_, metrics.height());
+
+    lines_.clear();
+    qreal top = 0;
+    layout_.beginLayout();
+    for (QTextLine line = layout_.createLine(); line.isValid(); line = layout_.createLine()) {
+        line.setLineWidth(width());
+        line.setPosition(QPointF(0, top + (lineSpacing_ - line.height()) / 2));
+
+        Line cached;
+        cached.start = line.textStart();
+        cached.length = line.textLength();
+        cached.top = top;
+        lines_.append(cached);
+
+        top += lineSpacing_;
+    }
+    layout_.endLayout();
+
+    // Глифы строк достаются один раз и переиспользуются при каждой перерисовке
+    for (int i = 0; i < lines_.size(); ++i) {
+        lines_[i].glyphRuns = layout_.lineAt(i).glyphRuns();
+    }
+
+    contentHeight_ = qCeil(top);
+    dirty_ = QRegion();
+    updateGeometry();
+    update();
+}
+
+int TypingView::lineIndexAt(int textPosition) const {
+    if (lines_.isEmpty()) {
+        return -1;
+    }
+    if (textPosition >= targetText_.length()) {
+        return lines_.size() - 1;
+    }
+    const QTextLine line = layout_.lineForTextPosition(textPosition);
+    return line.isValid() ? line.lineNumber() : -1;
+}
+
+QRectF TypingView::charRect(int index) const {
+    const int lineIndex = lineIndexAt(index);
+    if (lineIndex < 0) {
+        return QRectF();
+    }
+
+    const QTextLine line = layout_.lineAt(lineIndex);
+    const qreal x1 = line.cursorToX(index);
+    const qreal x2 = index < targetText_.length()
+        ? line.cursorToX(layout_.nextCursorPosition(index))
+        : x1 + kCaretMinWidth;
+    return QRectF(qMin(x1, x2), lines_[lineIndex].top, qMax(qAbs(x2 - x1), kCaretMinWidth), lineSpacing_);
+}
+
+void TypingView::updateChar(int index) {
+    const QRectF rect = charRect(index);
+    if (!rect.isNull()) {
+        dirty_ += rect.toAlignedRect().adjusted(-1, 0, 1, 0);
+        scheduler_.requestFrame();
+    }
+}
+
+void TypingView::flushDirty() {
+    if (!dirty_.isEmpty()) {
+        update(dirty_);
+        dirty_ = QRegion();
+    }
+}
+
+QColor TypingView::colorFor(CharState state) const {
+    switch (state) {
+    case CharState::Correct:
+        return kCorrectColor;
+    case CharState::Error:
+        return kErrorColor;
+    case CharState::Pending:
+        break;
+    }
+    return textColor_;
+}
+
+void TypingView::paintEvent(QPaintEvent *event) {
+    if (lines_.isEmpty()) {
+        emit painted();
+        return;
+    }
+
+    QPainter painter(this);
+    painter.setRenderHint(QPainter::TextAntialiasing);
+
+    // Строки имеют одинаковую высоту, поэтому видимый диапазон вычисляется сразу
+    const QRect dirty = event->rect();
+    const int first = qBound(0, int(dirty.top() / lineSpacing_), int(lines_.size()) - 1);
+    const int last = qBound(0, int(dirty.bottom() / lineSpacing_), int(lines_.size()) - 1);
+    for (int i = first; i <= last; ++i) {
+        paintLine(painter, i);
+    }
+    painter.end();
+
+    emit painted();
+}
+
+void TypingView::paintLine(QPainter &painter, int lineIndex) {
+    const Line &cached = lines_[lineIndex];
+    const QTextLine line = layout_.lineAt(lineIndex);
+    const int end = cached.start + cached.length;
+    const bool caretInLine = isInLine(caretIndex_, lineIndex);
+
+    if (caretInLine && caretStyle_ == "▮") {
+        painter.fillRect(charRect(caretIndex_), kCaretBlockColor);
+    }
+
+    // Символы строки группируются в отрезки с одинаковым цветом; каждый отрезок
+    // закрашивается кешированными глифами строки, обрезанными по его границам
+    int runStart = cached.start;
+    while (runStart < end) {
+        const bool isCaret = runStart == caretIndex_ && caretStyle_ == "_";
+        const CharState state = states_[runStart];
+        int runEnd = isCaret ? qMin(layout_.nextCursorPosition(runStart), end) : runStart + 1;
+        if (!isCaret) {
+            while (runEnd < end && states_[runEnd] == state && runEnd != caretIndex_) {
+                ++runEnd;
+            }
+        }
+
+        const qreal x1 = line.cursorToX(runStart);
+        const qreal x2 = line.cursorToX(runEnd);
+        const QRectF clip(qMin(x1, x2), cached.top, qAbs(x2 - x1), lineSpacing_);
+
+        painter.save();
+        painter.setClipRect(clip);
+        painter.setPen(isCaret ? QColor(Qt::white) : colorFor(state));
+        for (const QGlyphRun &run : cached.glyphRuns) {
+            painter.drawGlyphRun(QPointF(0, 0), run);
+        }
+        painter.restore();
+
+        runStart = runEnd;
+    }
+
+    const qreal underlineY = line.y() + line.ascent() + kUnderlineOffset;
+    for (int i = cached.start; i < end; ++i) {
+        if (states_[i] == CharState::Error && targetText_.at(i) == ' ') {
+            const QRectF rect = charRect(i);
+            painter.setPen(kErrorColor);
+            painter.drawLine(QPointF(rect.left(), underlineY), QPointF(rect.right(), underlineY));
+        }
+    }
+
+    if (ghostIndex_ >= 0 && isInLine(ghostIndex_, lineIndex)) {
+        const QRectF ghost = charRect(ghostIndex_);
+        painter.fillRect(QRectF(ghost.left(), ghost.top(), kGhostCaretWidth, ghost.height()), kGhostCaretColor);
+    }
+
+    if (!caretInLine) {
+        return;
+    }
+    const QRectF caret = charRect(caretIndex_);
+    if (caretStyle_ == "_") {
+        painter.setPen(Qt::white);
+        painter.drawLine(QPointF(caret.left(), underlineY), QPointF(caret.right(), underlineY));
+    } else if (caretStyle_ == "▯") {
+        painter.setPen(textColor_);
+        painter.drawRect(caret.adjusted(0, 0, -1, -1));
+    }
+}
+
+bool TypingView::isInLine(int index, int lineIndex) const {
+    const Line &cached = lines_[lineIndex];
+    const int end = cached.start + cached.length;
+    return index >= cached.start && (index < end || (index == end && lineIndex == lines_.size() - 1));
+}
@@ -0,0 +1,93 @@
+#ifndef TYPINGVIEW_H
+#define TYPINGVIEW_H
+
+#include <QWidget>
+#include <QFont>
+#include <QColor>
+#include <QGlyphRun>
+#include <QTextLayout>
+#include <QRegion>
+#include <QVector>
+#include "framescheduler.h"
+#include "typingsession.h"
+
+// Поле для набора текста. Текст раскладывается через QTextLayout один раз —
+// при смене текста или настроек, — глифы строк кешируются, а состояния
+// символов (набран верно, ошибка, ожидает) рисуются цветом поверх этих глифов.
+// Нажатие клавиши перерисовывает только прямоугольники изменившихся символов,
+// причем не чаще одного раза за кадр экрана.
+class TypingView : public QWidget {
+    Q_OBJECT
+
+public:
+    explicit TypingView(QWidget *parent = nullptr);
+
+    void setTargetText(const QString &text);
+    QString targetText() const;
+    void clearText();
+    // Бесконечный текст: убирает retiredLength единиц из начала и дописывает appended
+    // в конец за одну раскладку; состояния и каретка сдвигаются вместе с текстом
+    void scrollText(int retiredLength, const QString &appended);
+
+    // Позиции — UTF-16 индексы в тексте; графема из нескольких единиц
+    // окрашивается целиком и каретка занимает ее полную ширину
+    void setCharState(int position, int length, CharState state);
+    void setCaret(int position);
+    // Каретка записанного заезда; -1 скрывает ее
+    void setGhostCaret(int position);
+    QRect caretRect() const;
+    // Номер строки раскладки с позицией и начало строки (UTF-16 индекс)
+    int lineAt(int position) const { return lineIndexAt(position); }
+    int lineStart(int line) const { return lines_[line].start; }
+
+    const FrameScheduler &frameScheduler() const { return scheduler_; }
+    void setTextStyle(const QFont &font, const QColor &color, int lineHeight, const QString &caretStyle);
+
+    QSize sizeHint() const override;
+
+signals:
+    // Перерисовка завершена; используется для замера задержки ввода
+    void painted();
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+    void resizeEvent(QResizeEvent *event) override;
+    void showEvent(QShowEvent *event) override;
+
+private:
+    struct Line {
+        int start = 0;
+        int length = 0;
+        qreal top = 0;
+        QList<QGlyphRun> glyphRuns;
+    };
+
+    void relayout();
+    int lineIndexAt(int textPosition) const;
+    QRectF charRect(int index) const;
+    void updateChar(int index);
+    void flushDirty();
+    QColor colorFor(CharState state) const;
+    void paintLine(QPainter &painter, int lineIndex);
+    bool isInLine(int index, int lineIndex) const;
+
+    QString targetText_;
+    QTextLayout layout_;
+    QVector<Line> lines_;
+    QVector<CharState> states_;
+    int caretIndex_ = 0;
+    int ghostIndex_ = -1;
+
+    QFont font_;
+    QColor textColor_ = Qt::white;
+    QString caretStyle_;
+    int lineHeight_ = 0;
+    qreal lineSpacing_ = 0;
+    int contentHeight_ = 0;
+
+    // Изменившиеся прямоугольники копятся до ближайшего кадра
+    QRegion dirty_;
+    FrameScheduler scheduler_;
+};
+
+#endif // TYPINGVIEW_H
@@ -1,7 +1,7 @@
 #include "window.h"
 
 Window::Window(Database &db, QWidget *parent)
-    : QWidget(parent), database_(db) {
+    : QWidget(parent), aiPrefetch_(&Window::AiRequest), database_(db) {
 
     // --- Настройка виджета настроек ---
     settingsWidget_ = new SettingsWidget(database_, currentUsername_, this);
@@ -24,17 +24,68 @@ Window::Window(Database &db, QWidget *parent)
         ApplyTextStyles();
     });
 
-    // --- Таймер для подсчета WPM ---
+    // --- Таймер только обновляет отображение; время берется из ленты нажатий ---
+    keyClock_.start();
     typing_timer_ = new QTimer(this);
     typing_timer_->setInterval(kIntervalMs);
     connect(typing_timer_, &QTimer::timeout, this, &Window::UpdateWPM);
-    elapsed_seconds_ = 0;
+
+    // Генерация текста AI в рабочем потоке с индикатором в строке состояния
+    aiSpinnerTimer_ = new QTimer(this);
+    aiSpinnerTimer_->setInterval(kAiSpinnerIntervalMs);
+    connect(aiSpinnerTimer_, &QTimer::timeout, this, &Window::UpdateAiSpinner);
+    connect(&aiGenerator_, &AiTextGenerator::started, this, [this]() {
+        aiSpinnerFrame_ = 0;
+        UpdateAiSpinner();
+        aiSpinnerTimer_->start();
+    });
+    connect(&aiGenerator_, &AiTextGenerator::partial, this, &Window::OnAiTextPartial);
+    connect(&aiGenerator_, &AiTextGenerator::finished, this, [this](const QString& text) {
+        database_.saveAiResponse(AiCacheKeyFor(aiRequestLanguage_), text, true, kAiCacheMaxEntries);
+        if (aiStreaming_) {
+            FinishAiStream();
+        } else {
+            OnAiTextReady(aiRequestLanguage_, text);
+        }
+    });
+    connect(&aiGenerator_, &AiTextGenerator::failed, this, &Window::OnAiTextFailed);
+
+    // Глубина, порог дозаполнения и число параллельных запросов предзагрузки:
+    // KEYBOARD_TRAINER_AI_PREFETCH_DEPTH, _WATERMARK и _CONCURRENCY
+    bool ok = false;
+    const int prefetchDepth = qEnvironmentVariableIntValue("KEYBOARD_TRAINER_AI_PREFETCH_DEPTH", &ok);
+    if (ok) {
+        aiPrefetch_.setDepth(prefetchDepth);
+    }
+    const int prefetchWatermark = qEnvironmentVariableIntValue("KEYBOARD_TRAINER_AI_PREFETCH_WATERMARK", &ok);
+    if (ok) {
+        aiPrefetch_.setLowWatermark(prefetchWatermark);
+    }
+    const int prefetchConcurrency = qEnvironmentVariableIntValue("KEYBOARD_TRAINER_AI_PREFETCH_CONCURRENCY", &ok);
+    if (ok) {
+        aiPrefetch_.setConcurrency(prefetchConcurrency);
+    }
+    connect(&aiPrefetch_, &AiPrefetchQueue::changed, this, &Window::UpdateLatencyOverlay);
+    // Каждый сгенерированный текст сохраняется в кэш ответов; набранные помечаются там же
+    connect(&aiPrefetch_, &AiPrefetchQueue::fetched, this, [this](const QString& language, const QString& text) {
+        database_.saveAiResponse(AiCacheKeyFor(language), text, false, kAiCacheMaxEntries);
+    });
+
+    // Режим на время: тест заканчивается по таймеру, а не по концу текста
+    timedTimer_ = new QTimer(this);
+    timedTimer_->setSingleShot(true);
+    connect(timedTimer_, &QTimer::timeout, this, &Window::FinishSession);
+
+    ghostTimer_ = new QTimer(this);
+    ghostTimer_->setInterval(kGhostFrameMs);
+    connect(ghostTimer_, &QTimer::timeout, this, &Window::AdvanceGhost);
+
+    // Принимаем строки подтверждения IME (китайский, японский и т.п.)
+    setAttribute(Qt::WA_InputMethodEnabled);
 
     // --- Настройка меток ---
-    generated_text_ = new QLabel(this);
+    generated_text_ = new TypingView(this);
     generated_text_->setObjectName("generatedText");
-    generated_text_->setAlignment(Qt::AlignHCenter | Qt::AlignTop);
-    generated_text_->setWordWrap(true);
     generated_text_->setFixedWidth(kTextFieldWidth);
     generated_text_->setSizePolicy(QSizePolicy::Preferred, QSizePolicy::Expanding);
     generated_text_->setMinimumHeight(kTextFieldMinimumHeigth);
@@ -43,10 +94,63 @@ Window::Window(Database &db, QWidget *parent)
     statusLabel_->setObjectName("statusLabel");
     statusLabel_->setAlignment(Qt::AlignBottom | Qt::AlignCenter);
 
+    // Оверлей задержки ввода: F12 или KEYBOARD_TRAINER_LATENCY_OVERLAY=1
+    latencyLabel_ = new QLabel(this);
+    latencyLabel_->setObjectName("latencyLabel");
+    latencyLabel_->setAlignment(Qt::AlignBottom | Qt::AlignLeft);
+    latencyLabel_->setVisible(qEnvironmentVariableIntValue("KEYBOARD_TRAINER_LATENCY_OVERLAY") == 1);
+
+    pendingInputsNs_.reserve(kPendingInputsReserve);
+    connect(generated_text_, &TypingView::painted, this, &Window::RecordInputLatency);
+    connect(qApp, &QCoreApplication::aboutToQuit, this, &Window::DumpInputLatency);
+
+    // Каталог наборов хранится рядом с keyboard_trainer.db. KEYBOARD_TRAINER_LANGUAGES
+    // подменяет встроенные наборы папкой на диске — ее изменения отслеживаются на лету
+    const QString languagesPath = qEnvironmentVariableIsSet("KEYBOARD_TRAINER_LANGUAGES")
+        ? qEnvironmentVariable("KEYBOARD_TRAINER_LANGUAGES") : kWordPacksPath;
+
+    // Наборы слов грузятся в фоне: встроенные .kwp отображаются в память,
+    // JSON из папки компилируется при каждой загрузке, чтобы правки не терялись
+    connect(&wordLoader_, &WordListLoader::loadingStarted, this, [this](const QString &name) {
+        statusLabel_->setText("Загрузка набора " + name + "...");
+    });
+    connect(&wordLoader_, &WordListLoader::loaded, this, &Window::OnWordListLoaded);
+    connect(&wordLoader_, &WordListLoader::failed, this, [this](const QString &error) {
+        statusLabel_->setText("RAW WPM: 0 | Точность: 100% | WPM: 0");
+        QMessageBox::warning(this, "Ошибка", error);
+    });
+
+    // Индекс поиска слов по всем наборам строится в фоне при первом открытии диалога
+    // наборов; изменения каталога только помечают его устаревшим
+    connect(&searchIndexWatcher_, &QFutureWatcher<QSharedPointer<const WordSearchIndex>>::finished, this, [this]() {
+        searchIndex_ = searchIndexWatcher_.result();
+        if (searchIndexQueued_) {
+            searchIndexQueued_ = false;
+            RebuildSearchIndex();
+        }
+    });
+    connect(&wordCatalog_, &WordSetCatalog::changed, this, [this]() { searchIndexStale_ = true; });
+
+    // Индекс адаптивного режима; пока он строился, могли выбрать другой набор
+    connect(&ngramIndexWatcher_, &QFutureWatcher<QSharedPointer<const NgramIndex>>::finished, this, [this]() {
+        const WordPackPtr words = std::exchange(ngramIndexWords_, WordPackPtr());
+        if (words != currentWords_) {
+            RebuildNgramIndex();
+            return;
+        }
+        ngramIndex_ = ngramIndexWatcher_.result();
+        // Еще не начатый текст пересобирается уже по слабым местам
+        if (adaptiveModeActive_ && wordsModeActive_ && !timedModeActive_ && !session_.isStarted()) {
+            GenerateNewTextFromWordList();
+        }
+    });
+
+    wordCatalog_.open(languagesPath, QDir::currentPath() + "/word_sets.json");
+
     // --- Кнопки настроек и входа ---
     auto settings_button = new QPushButton(this);
     settings_button->setStyleSheet("border: none; background: transparent;");
-    settings_button->setIcon(QIcon("/Users/hronov/Documents/Keyboard Trainer/icons/settings.svg"));
+    settings_button->setIcon(QIcon(":/icons/settings.svg"));
     settings_button->setIconSize(QSize(46, 46));
     settings_button->setFlat(true);
     settings_button->setCursor(Qt::PointingHandCursor);
@@ -54,7 +158,7 @@ Window::Window(Database &db, QWidget *parent)
 
     auto login_button = new QPushButton(this);
     login_button->setStyleSheet("border: none; background: transparent;");
-    login_button->setIcon(QIcon("/Users/hronov/Documents/Keyboard Trainer/icons/account.svg"));
+    login_button->setIcon(QIcon(":/icons/account.svg"));
     login_button->setIconSize(QSize(44, 45));
     login_button->setFlat(true);
     login_button->setCursor(Qt::PointingHandCursor);
@@ -79,7 +183,7 @@ Window::Window(Database &db, QWidget *parent)
     categoryLayout->setSpacing(20);
     categoryLayout->setAlignment(Qt::AlignCenter);
 
-    auto addCategoryWidget = [&](const QString &text, bool isButton = false) {
+    auto addCategoryWidget = [&](const QString &text, bool isButton = false, bool isToggle = false) {
         if (!isButton) {
             QLabel *label = new QLabel(text, categoryWidget);
             label->setStyleSheet(R"(
@@ -96,13 +200,20 @@ Window::Window(Database &db, QWidget *parent)
             QPushButton *button = new QPushButton(text, categoryWidget);
             button->setFlat(true);
             button->setCursor(Qt::PointingHandCursor);
+            // Переключатели режимов подсвечиваются, пока включены
+            button->setCheckable(isToggle);
             button->setStyleSheet(R"(
-                color: #eee;
-                font-size: 14px;
-                padding: 5px 12px;
-                background-color: rgba(245, 245, 245, 0.15);
-                border-radius: 8px;
-                font-weight: 600;
+                QPushButton {
+                    color: #eee;
+                    font-size: 14px;
+                    padding: 5px 12px;
+                    background-color: rgba(245, 245, 245, 0.15);
+                    border-radius: 8px;
+                    font-weight: 600;
+                }
+                QPushButton:checked {
+                    background-color: rgba(136, 192, 208, 0.45);
+                }
             )");
             categoryLayout->addWidget(button);
 
@@ -112,7 +223,13 @@ Window::Window(Database &db, QWidget *parent)
                 { "language", [this]() { ShowLanguageDialog(); } },
                 { "stop", [this]() { DisableTyping(); } },
                 { "stats", [this]() { ShowStats(); } },
+                { "ghost", [this]() { ShowGhostDialog(); } },
+                { "adaptive", [this]() { ToggleAdaptiveMode(); } },
+                { "punctuation", [this]() { TogglePunctuation(); } },
+                { "time", [this]() { ShowTimeMenu(); } },
+                { "numbers", [this]() { ToggleNumbers(); } },
                 { "quote", [this]() { random(); } },
+                { "custom", [this]() { LoadTextFromFile(); } },
             };
 
             connect(button, &QPushButton::clicked, this, [this, text, actions]() {
@@ -127,12 +244,14 @@ Window::Window(Database &db, QWidget *parent)
     // Добавляем кнопки и метки категорий
     addCategoryWidget("ai", true);
     addCategoryWidget("language", true);
-    addCategoryWidget("punctuation");
-    addCategoryWidget("numbers");
-    addCategoryWidget("time");
+    addCategoryWidget("punctuation", true, true);
+    addCategoryWidget("numbers", true, true);
+    addCategoryWidget("time", true);
     addCategoryWidget("words", true);
+    addCategoryWidget("adaptive", true, true);
     addCategoryWidget("quote",true);
     addCategoryWidget("custom", true);
+    addCategoryWidget("ghost", true);
     addCategoryWidget("stop", true);
     addCategoryWidget("stats", true);
 
@@ -149,7 +268,12 @@ Window::Window(Database &db, QWidget *parent)
     main_layout->addLayout(categoryWrapperLayout);
     main_layout->addSpacing(20);
     main_layout->addWidget(generated_text_, 0, Qt::AlignHCenter);
-    main_layout->addWidget(statusLabel_);
+    auto statusLayout = new QHBoxLayout();
+    statusLayout->addStretch();
+    statusLayout->addWidget(statusLabel_);
+    statusLayout->addWidget(latencyLabel_);
+    statusLayout->addStretch();
+    main_layout->addLayout(statusLayout);
     main_layout->addStretch();
     main_layout->setAlignment(Qt::AlignTop);
 
@@ -189,12 +313,10 @@ Window::Window(Database &db, QWidget *parent)
             letter-spacing: 2px;
             word-spacing: 2px;
         }
-        QLabel#generatedText {
-            font-size: 16px;
-            letter-spacing: 2px;
-            word-spacing: 2px;
-            font-weight: 500;
-            color: #eceff4;
+        QLabel#latencyLabel {
+            font-size: 13px;
+            color: #a3be8c;
+            padding-left: 20px;
         }
         QWidget#categoryWidget {
             background-color: rgba(255, 255, 255, 0.15);
@@ -209,12 +331,31 @@ Window::Window(Database &db, QWidget *parent)
         }
     )";
     setStyleSheet(globalStyle);
+
+    // Поле набора раскладывается заново только здесь и при settingsChanged
+    ApplyTextStyles();
 }
 
 // === Методы ---
 
 void Window::SetLanguage(const QString& language) {
     prompt_language_ = language;
+    // Ненабранные тексты из кэша ответов идут в очередь раньше сети
+    aiPrefetch_.seed(language, database_.getUnusedAiResponses(AiCacheKeyFor(language), aiPrefetch_.depth()));
+    aiPrefetch_.setLanguage(language);
+}
+
+QString Window::AiRequest(const QString& language) {
+    return QString::fromStdString(
+        kPromptTemplatePart1
+        + std::to_string(kWordsNumber)
+        + kPromptTemplatePart2
+        + "IMPORTANT. set-language:" + language.toStdString()
+    );
+}
+
+AiCacheKey Window::AiCacheKeyFor(const QString& language) {
+    return AiCacheKey { language, QString::fromStdString(kPromptTemplatePart1 + kPromptTemplatePart2), kWordsNumber };
 }
 
 void Window::Prompt() {
@@ -223,34 +364,154 @@ void Window::Prompt() {
         return;
     }
 
-    try {
-        typing_allowed_ = false;
+    typing_allowed_ = false;
+    bookModeActive_ = false;
+    wordsModeActive_ = false;
+    aiStreaming_ = false;
+    aiStreamBuffer_.clear();
+
+    // Текст из очереди предзагрузки или еще не набранный текст из кэша показывается
+    // сразу, без похода в сеть, и считается попаданием
+    const AiCacheKey cacheKey = AiCacheKeyFor(prompt_language_);
+    QString text;
+    bool cached = aiPrefetch_.take(prompt_language_, text);
+    if (cached) {
+        database_.markAiResponseUsed(cacheKey, text);
+    } else {
+        cached = database_.takeAiResponse(cacheKey, false, text);
+    }
+    database_.recordAiCacheLookup(cached);
+    if (cached) {
+        aiGenerator_.cancel();
+        OnAiTextReady(prompt_language_, text);
+        return;
+    }
 
-        QString request = QString::fromStdString(
-            kPromptTemplatePart1
-            + std::to_string(kWordsNumber)
-            + kPromptTemplatePart2
-            + "IMPORTANT. set-language:" + prompt_language_.toStdString()
-        );
+    // Запрос идет в фоне; окно продолжает перерисовываться и принимать ввод
+    aiRequestLanguage_ = prompt_language_;
+    aiGenerator_.generate(AiRequest(aiRequestLanguage_));
+}
 
-        QString result_final = QString::fromStdString(getResponse(request.toStdString()));
-        generated_text_->setText(result_final);
-        ResetText();
+void Window::OnAiTextReady(const QString& language, const QString& text, bool streaming) {
+    aiSpinnerTimer_->stop();
+    pipelineLanguage_ = language;
+    RebuildTextPipeline();
+    generated_text_->setTargetText(ApplyProsePipeline(text));
+    ResetText();
+    // Пока ответ догружается, сессия не заканчивается на конце пришедшего текста
+    session_.setOpenEnded(streaming);
+    aiStreaming_ = streaming;
+
+    effect_ = new QGraphicsOpacityEffect(this);
+    generated_text_->setGraphicsEffect(effect_);
+
+    animation_ = new QPropertyAnimation(effect_, "opacity");
+    animation_->setDuration(kAnimationDurationMs);
+    animation_->setStartValue(0.0);
+    animation_->setEndValue(1.0);
+    animation_->start(QAbstractAnimation::DeleteWhenStopped);
+
+    typing_allowed_ = true;
+}
+
+void Window::OnAiTextPartial(const QString& delta) {
+    aiStreamBuffer_ += delta;
+    if (aiStreaming_) {
+        ReleaseAiStream(false);
+        return;
+    }
+
+    // Набор начинается, как только пришло первое предложение целиком; после
+    // точки нужен пробел, иначе это может быть многоточие или сокращение.
+    // В CJK пробелов после знаков нет, поэтому им хватает самого знака
+    static const QRegularExpression kSentenceEnd(R"([.!?…؟։]\s|[。！？])");
+    const QRegularExpressionMatch match = kSentenceEnd.match(aiStreamBuffer_);
+    if (!match.hasMatch()) {
+        return;
+    }
+    const int end = match.capturedStart() + 1;
+    const QString sentence = aiStreamBuffer_.left(end).trimmed();
+    aiStreamBuffer_.remove(0, end);
+    OnAiTextReady(aiRequestLanguage_, sentence, true);
+    ReleaseAiStream(false);
+}
+
+void Window::ReleaseAiStream(bool all) {
+    if (!aiStreaming_) {
+        return;
+    }
+    // В сессию и раскладку уходят только целые слова: хвост до последнего пробела
+    // ждет продолжения, чтобы пайплайн и перенос строк не видели обрывков
+    qsizetype end = aiStreamBuffer_.size();
+    if (!all) {
+        while (end > 0 && !aiStreamBuffer_.at(end - 1).isSpace()) {
+            --end;
+        }
+        // Пробельный символ остается в буфере и открывает следующую порцию
+        end = qMax<qsizetype>(0, end - 1);
+    }
+    if (end == 0) {
+        return;
+    }
 
-        effect_ = new QGraphicsOpacityEffect(this);
-        generated_text_->setGraphicsEffect(effect_);
+    QString chunk = aiStreamBuffer_.left(end);
+    aiStreamBuffer_.remove(0, end);
+    if (all) {
+        while (!chunk.isEmpty() && chunk.back().isSpace()) {
+            chunk.chop(1);
+        }
+    }
+    const QString appended = ApplyProsePipeline(chunk, true);
+    if (appended.isEmpty()) {
+        return;
+    }
+    session_.append(appended);
+    generated_text_->scrollText(0, appended);
+    UpdateCaret();
+}
 
-        animation_ = new QPropertyAnimation(effect_, "opacity");
-        animation_->setDuration(kAnimationDurationMs);
-        animation_->setStartValue(0.0);
-        animation_->setEndValue(1.0);
-        animation_->start(QAbstractAnimation::DeleteWhenStopped);
+void Window::FinishAiStream() {
+    ReleaseAiStream(true);
+    aiStreaming_ = false;
+    session_.setOpenEnded(false);
+    // Пользователь мог дойти до конца текста раньше, чем закончился ответ
+    if (session_.isFinished()) {
+        FinishSession();
+    }
+}
 
-        typing_allowed_ = true;
+void Window::OnAiTextFailed(const QString& error) {
+    aiSpinnerTimer_->stop();
+    // Оборванный поток: уже пришедший текст остается для набора
+    if (aiStreaming_) {
+        FinishAiStream();
+        return;
+    }
+    statusLabel_->setText("RAW WPM: 0 | Точность: 100% | WPM: 0");
 
-    } catch (const nlohmann::json::type_error&) {
-        QMessageBox::warning(this, "Ошибка", "Ошибка обработки JSON-ответа. Попробуйте включить VPN.");
+    // Без сети лучше повторить уже набранный текст, чем не показать ничего
+    QString text;
+    if (database_.takeAiResponse(AiCacheKeyFor(aiRequestLanguage_), true, text)) {
+        OnAiTextReady(aiRequestLanguage_, text);
+        return;
     }
+    QMessageBox::warning(this, "Ошибка", error);
+}
+
+void Window::CancelAiGeneration() {
+    aiStreaming_ = false;
+    aiStreamBuffer_.clear();
+    if (aiGenerator_.isBusy()) {
+        aiGenerator_.cancel();
+        aiSpinnerTimer_->stop();
+        statusLabel_->setText("RAW WPM: 0 | Точность: 100% | WPM: 0");
+    }
+}
+
+void Window::UpdateAiSpinner() {
+    static const QString kFrames = "⠋⠙⠹⠸⠼⠴⠦⠧⠇⠏";
+    aiSpinnerFrame_ = (aiSpinnerFrame_ + 1) % kFrames.size();
+    statusLabel_->setText(QString("%1 Генерация текста...").arg(kFrames.at(aiSpinnerFrame_)));
 }
 
 void Window::ShowLanguageDialog() {
@@ -283,22 +544,24 @@ void Window::ShowLanguageDialog() {
 }
 
 void Window::DisableTyping() {
+    CancelAiGeneration();
     if (typing_allowed_) {
         typing_allowed_ = false;
-        generated_text_->clear();
+        bookModeActive_ = false;
+        generated_text_->clearText();
         ResetText();
     }
 }
 
 void Window::ResetText() {
-    targetText_ = generated_text_->text();
-
-    typedChars_.fill('|', targetText_.length());
-    errorFlags_.fill(false, targetText_.length());
-
-    currentIndex_ = 0;
-    errorCount_ = 0;
-    typedCharCount_ = 0;
+    // Каждый новый текст проходит здесь; дописывать поток AI в него нельзя
+    if (aiStreaming_) {
+        CancelAiGeneration();
+    }
+    session_.reset(generated_text_->targetText());
+    session_.setOpenEnded(IsTimedTest());
+    timedTimer_->stop();
+    StopGhost();
 
     statusLabel_->setText("RAW WPM: 0 | Точность: 100% | WPM: 0");
 
@@ -307,7 +570,6 @@ void Window::ResetText() {
 
 void Window::StartTypingTimer() {
     if (!typing_timer_->isActive()) {
-        elapsed_seconds_ = 0;
         typing_timer_->start();
     }
 }
@@ -317,24 +579,36 @@ void Window::StopTypingTimer() {
 }
 
 void Window::UpdateWPM() {
-    elapsed_seconds_ += kUpdateIntervalSec;
-    const double minutes = elapsed_seconds_ / kSecondsInMinute;
+    UpdateLatencyOverlay();
+    if (!session_.isStarted()) {
+        return;
+    }
 
-    if (minutes > 0) {
-        double raw_wpm = (static_cast<double>(typedCharCount_) / kWpmCoefficient) / minutes;
-        double accuracy = kHundred - ((static_cast<double>(errorCount_) / targetText_.length()) * kHundred);
-        accuracy = qMax(accuracy, 0.0);
+    const qint64 now = keyClock_.nsecsElapsed();
+    ShowScore(session_.rawWpm(now), session_.accuracy(), session_.wpm(now));
+}
 
-        statusLabel_->setText(
-            QString("RAW WPM: %1 | Точность: %2% | WPM: %3")
-            .arg(QString::number(raw_wpm, 'f', 2))
-            .arg(QString::number(accuracy, 'f', 2))
-            .arg(QString::number(raw_wpm * accuracy / kHundred, 'f', 2))
-        );
+void Window::ShowScore(double raw_wpm, double accuracy, double wpm) {
+    QString score = QString("RAW WPM: %1 | Точность: %2% | WPM: %3")
+        .arg(QString::number(raw_wpm, 'f', 2))
+        .arg(QString::number(accuracy, 'f', 2))
+        .arg(QString::number(wpm, 'f', 2));
+    if (timedTimer_->isActive()) {
+        score += QString(" | Осталось: %1 с").arg((timedTimer_->remainingTime() + 999) / 1000);
     }
+    statusLabel_->setText(score);
 }
 
 void Window::keyPressEvent(QKeyEvent* event) {
+    // Отметка ставится сразу, до любой обработки, чтобы не зависеть от нагрузки на UI
+    const qint64 timestamp = keyClock_.nsecsElapsed();
+
+    if (event->key() == Qt::Key_F12) {
+        latencyLabel_->setVisible(!latencyLabel_->isVisible());
+        UpdateLatencyOverlay();
+        return;
+    }
+
     if (!typing_allowed_) {
         return;
     }
@@ -345,104 +619,188 @@ void Window::keyPressEvent(QKeyEvent* event) {
         return;
     }
 
-    typedCharCount_ = 0;
-
     if (event->key() == Qt::Key_Backspace) {
-        if (currentIndex_ > 0) {
-            --currentIndex_;
-            typedChars_[currentIndex_] = '|';
-            errorFlags_[currentIndex_] = false;
-            typedCharCount_--;
+        if (session_.backspace(timestamp)) {
+            const int index = session_.currentIndex();
+            generated_text_->setCharState(session_.clusterStart(index), session_.clusterLength(index),
+                                          CharState::Pending);
+            MarkInputPending(timestamp);
         }
+        UpdateCaret();
     } else {
-        const QString new_text = event->text();
-        if (!new_text.isEmpty() && currentIndex_ < targetText_.length()) {
-            if (currentIndex_ == 0)
-                StartTypingTimer();
-
-            const QChar expected_char = targetText_.at(currentIndex_);
-            const QChar typed_char = new_text.at(0);
-
-            if (typed_char == expected_char) {
-                errorFlags_[currentIndex_] = false;
-            } else {
-                errorFlags_[currentIndex_] = true;
-                errorCount_++;
-            }
+        TypeText(event->text(), timestamp);
+    }
+}
+
+void Window::inputMethodEvent(QInputMethodEvent* event) {
+    const qint64 timestamp = keyClock_.nsecsElapsed();
 
-            typedChars_[currentIndex_] = typed_char;
-            currentIndex_++;
+    // Строка подтверждения IME принимается целиком
+    if (typing_allowed_ && !event->commitString().isEmpty()) {
+        TypeText(event->commitString(), timestamp);
+    }
+    event->accept();
+}
+
+QVariant Window::inputMethodQuery(Qt::InputMethodQuery query) const {
+    switch (query) {
+    case Qt::ImEnabled:
+        return typing_allowed_;
+    case Qt::ImCursorRectangle:
+        // Окно кандидатов IME открывается у каретки
+        return QRect(generated_text_->mapTo(this, generated_text_->caretRect().topLeft()),
+                     generated_text_->caretRect().size());
+    default:
+        return QWidget::inputMethodQuery(query);
+    }
+}
+
+void Window::TypeText(const QString &text, qint64 timestamp) {
+    if (text.isEmpty()) {
+        return;
+    }
+
+    const bool first_key = !session_.isStarted();
+    const qint64 previous_ns = first_key ? -1 : session_.timeline().lastTimestampNs();
+    const int first_index = session_.currentIndex();
+    const int typed = session_.type(text, timestamp);
+    if (typed == 0) {
+        return;
+    }
+    MarkInputPending(timestamp);
+
+    if (first_key) {
+        StartTypingTimer();
+        if (IsTimedTest()) {
+            timedTimer_->start(timedDurationSec_ * 1000);
+        }
+        if (!ghostKeys_.isEmpty()) {
+            raceStartNs_ = timestamp;
+            ghostTimer_->start();
         }
     }
 
-    QString colored_text;
+    for (int index = first_index; index < first_index + typed; ++index) {
+        const CharState state = session_.stateAt(index);
+        generated_text_->setCharState(session_.clusterStart(index), session_.clusterLength(index), state);
 
-    for (int i = 0; i < targetText_.length(); ++i) {
-        if (typedChars_[i] != '|') {
-            QString color = errorFlags_[i] ? "red" : "green";
-            QChar target_char = targetText_.at(i);
+        // Задержка есть только у первой графемы: остальные пришли в том же событии
+        const bool has_interval = index == first_index && previous_ns >= 0;
+        keyStats_.add(index > 0 ? session_.codepointAt(index - 1) : 0,
+                      session_.codepointAt(index),
+                      has_interval ? (timestamp - previous_ns) / 1e6 : -1.0,
+                      state == CharState::Error);
+    }
 
-            if (target_char == ' ' && errorFlags_[i]) {
-                colored_text += "<span style='text-decoration: underline; color: red;'> </span>";
-            } else {
-                colored_text += "<span style='color:" + color + ";'>" + QString(target_char) + "</span>";
-            }
-            typedCharCount_++;
+    if (IsTimedTest()) {
+        AdvanceTimedText();
+    }
+    UpdateCaret();
+
+    if (session_.isFinished()) {
+        FinishSession();
+    }
+}
+
+void Window::UpdateCaret() {
+    // Перекрашиваются только символ под кареткой и предыдущая позиция
+    const int index = session_.currentIndex();
+    generated_text_->setCaret(index < session_.length() ? session_.clusterStart(index)
+                                                        : session_.targetText().length());
+}
+
+void Window::FinishSession() {
+    typing_allowed_ = false;
+    StopTypingTimer();
+    timedTimer_->stop();
+
+    // Итог считается по отметке последнего нажатия, а не по тикам таймера
+    const double accuracy = session_.accuracy();
+    const double wpm = session_.finalWpm();
+    ShowScore(session_.finalRawWpm(), accuracy, wpm);
+    UpdateLatencyOverlay();
+
+    if (!currentUsername_.isEmpty()) {
+        // У теста на время целиком хранится только окно текста, поэтому запись для заезда не сохраняется
+        const KeystrokeRecorder &recorder = session_.recorder();
+        if (session_.isOpenEnded()) {
+            database_.saveTypingSession(currentUsername_, wpm, accuracy);
         } else {
-            if (i == currentIndex_) {
-                if (caretStyle_.isEmpty()) {
-                    colored_text += "<span style='color:" + textColor_.name() + ";'>" + QString(targetText_.at(i)) +
-                        "</span>";
-                } else if (caretStyle_ == "_") {
-                         colored_text += "<span style='text-decoration: underline; color: white;'>" +
-                            QString(targetText_.at(i)) +
-                        "</span>";
-                    } else if (caretStyle_ == "▮") {
-                        colored_text += "<span style='background-color: rgba(0,0,0,0.4); color:" +
-                textColor_.name() + "'>" + QString(targetText_.at(i)) + "</span>";
-                    }
-            } else {
-                colored_text += "<span style='color:" + textColor_.name() + ";'>" + QString(targetText_.at(i))
-                 + "</span>";
-            }
+            database_.saveTypingSession(currentUsername_, wpm, accuracy,
+                                        session_.targetText(), recorder.data(), recorder.count());
         }
+        database_.saveKeyLatencyStats(currentUsername_, keyStats_.toByteArray());
     }
 
-    generated_text_->setText(colored_text);
+    if (bookModeActive_) {
+        AdvanceBookPage();
+    }
+}
 
-    if (currentIndex_ == targetText_.length()) {
-        typing_allowed_ = false;
-        double minutes = elapsed_seconds_ / kSecondsInMinute;
-        double raw_wpm = (typedCharCount_ / kWpmCoefficient) / minutes;
-        double accuracy = kHundred - ((double)errorCount_ / targetText_.length() * kHundred);
-        accuracy = qMax(accuracy, 0.0);
+void Window::MarkInputPending(qint64 timestamp) {
+    pendingInputsNs_.append(timestamp);
+}
 
+void Window::RecordInputLatency() {
+    if (pendingInputsNs_.isEmpty()) {
+        return;
+    }
 
-        if (!currentUsername_.isEmpty()) {
-            database_.saveTypingSession(currentUsername_, raw_wpm * accuracy / kHundred, accuracy);
-        }
+    // Все нажатия, пришедшие до этой перерисовки, стали видимы в ней
+    const qint64 now = keyClock_.nsecsElapsed();
+    for (qint64 arrival : pendingInputsNs_) {
+        inputLatency_.record(now - arrival);
+    }
+    pendingInputsNs_.clear();
+}
 
-        StopTypingTimer();
+void Window::UpdateLatencyOverlay() {
+    if (!latencyLabel_->isVisible()) {
+        return;
     }
+
+    auto ms = [](qint64 ns) { return QString::number(ns / 1e6, 'f', 2); };
+    const FrameScheduler &frames = generated_text_->frameScheduler();
+    latencyLabel_->setText(QString("ввод→кадр p50 %1 мс | p99 %2 мс | max %3 мс | кадров сэкономлено %4 из %5"
+                                   " | AI готово %6, попаданий %7, промахов %8")
+        .arg(ms(inputLatency_.percentileNs(50)))
+        .arg(ms(inputLatency_.percentileNs(99)))
+        .arg(ms(inputLatency_.maxNs()))
+        .arg(frames.skippedFrames())
+        .arg(frames.requestedFrames())
+        .arg(aiPrefetch_.readyCount(prompt_language_))
+        .arg(aiPrefetch_.hits())
+        .arg(aiPrefetch_.misses()));
+}
+
+void Window::DumpInputLatency() const {
+    if (inputLatency_.count() == 0) {
+        return;
+    }
+
+    QFile file(QDir::currentPath() + "/input_latency.hgrm");
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        qDebug() << "Failed to write input latency histogram:" << file.errorString();
+        return;
+    }
+
+    QTextStream out(&file);
+    out << "# Keyboard Trainer input-to-paint latency\n"
+        << "# host: " << QSysInfo::machineHostName()
+        << ", os: " << QSysInfo::prettyProductName()
+        << ", platform: " << QGuiApplication::platformName() << '\n'
+        << "# date: " << QDateTime::currentDateTime().toString(Qt::ISODate) << "\n\n";
+    inputLatency_.writePercentiles(out);
 }
 
 void Window::ApplyTextStyles() {
-    generated_text_->setStyleSheet(QString(
-        "font-family: '%7'; "
-        "font-size: %1px; "
-        "color: %2; "
-        "font-weight: %3; "
-        "letter-spacing: %4px; "
-        "word-spacing: %5px; "
-        "line-height: %6px;")
-        .arg(fontSize_)
-        .arg(textColor_.name())
-        .arg(fontWeight_)
-        .arg(letterSpacing_)
-        .arg(wordSpacing_)
-        .arg(lineHeight_)
-        .arg(currentFont_.family())
-    );
+    QFont font = currentFont_;
+    font.setPixelSize(fontSize_);
+    font.setWeight(QFont::Weight(fontWeight_));
+    font.setLetterSpacing(QFont::AbsoluteSpacing, letterSpacing_);
+    font.setWordSpacing(wordSpacing_);
+
+    generated_text_->setTextStyle(font, textColor_, lineHeight_, caretStyle_);
 }
 
 void Window::LoadTextFromFile() {
@@ -450,6 +808,13 @@ void Window::LoadTextFromFile() {
                                                     "Текстовые файлы (*.txt);;Все файлы (*.*)");
     if (file_name.isEmpty())
         return;
+    CancelAiGeneration();
+
+    // Большие файлы не читаются целиком, а набираются постранично
+    if (QFileInfo(file_name).size() > kBookModeThresholdBytes) {
+        OpenBook(file_name);
+        return;
+    }
 
     QFile file(file_name);
     if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
@@ -461,12 +826,57 @@ void Window::LoadTextFromFile() {
     QString text = in.readAll();
     file.close();
 
-    generated_text_->setText(text);
+    wordsModeActive_ = false;
+    bookModeActive_ = false;
+    generated_text_->setTargetText(ApplyProsePipeline(text));
+    ResetText();
+    typing_allowed_ = true;
+}
+
+void Window::OpenBook(const QString& path) {
+    if (!book_.open(path)) {
+        QMessageBox::warning(this, "Ошибка", "Не удалось открыть файл.");
+        return;
+    }
+
+    wordsModeActive_ = false;
+    bookModeActive_ = true;
+    bookOffset_ = currentUsername_.isEmpty() ? 0 : database_.getBookPosition(currentUsername_, path);
+    if (book_.atEnd(bookOffset_)) {
+        bookOffset_ = 0;
+    }
+    ShowBookPage();
+}
+
+void Window::ShowBookPage() {
+    QString page = book_.page(bookOffset_, &bookNextOffset_);
+    while (page.isEmpty() && !book_.atEnd(bookNextOffset_)) {
+        bookOffset_ = bookNextOffset_;
+        page = book_.page(bookOffset_, &bookNextOffset_);
+    }
+
+    if (page.isEmpty()) {
+        bookModeActive_ = false;
+        book_.close();
+        QMessageBox::information(this, "Книга", "Книга дочитана до конца");
+        return;
+    }
+
+    generated_text_->setTargetText(ApplyProsePipeline(page));
     ResetText();
+    typing_allowed_ = true;
+}
+
+void Window::AdvanceBookPage() {
+    bookOffset_ = bookNextOffset_;
+    if (!currentUsername_.isEmpty()) {
+        database_.saveBookPosition(currentUsername_, book_.path(), bookOffset_);
+    }
+    ShowBookPage();
 }
 
 void Window::showLoginDialog() {
-    if (!database_.initDatabase()) {
+    if (!database_.isOpen() && !database_.initDatabase()) {
         QMessageBox::critical(this, "Ошибка", "Не удалось подключиться к базе данных");
         return;
     }
@@ -499,6 +909,7 @@ void Window::LoadUserSettings() {
     caretSmooth_ = caretMap.value(settings.caret_smooth);
     caretStyle_ = settings.caret_style;
 
+    keyStats_ = KeyLatencyStats::fromByteArray(database_.getKeyLatencyStats(currentUsername_));
 
     ApplyTextStyles();
 
@@ -546,14 +957,12 @@ void Window::ShowWordSetDialog() {
     blur->setBlurRadius(40);
     this->setGraphicsEffect(blur);
 
-    // Получаем список JSON файлов в папке языков
-    QString languagesPath = "/Users/hronov/Documents/Keyboard Trainer/languages";
-    QDir dir(languagesPath);
-    QStringList filters {"*.json"};
-    QFileInfoList fileList = dir.entryInfoList(filters, QDir::Files | QDir::NoSymLinks);
-
-    if (fileList.isEmpty()) {
-        QMessageBox::warning(this, "Ошибка", "Папка languages пуста или не найдены JSON файлы");
+    // Наборы берутся из каталога; папка языков при открытии диалога не читается
+    const QVector<WordSetInfo> &sets = wordCatalog_.entries();
+    if (sets.isEmpty()) {
+        QMessageBox::warning(this, "Ошибка", wordCatalog_.isScanning()
+            ? "Каталог наборов слов еще строится, попробуйте через пару секунд"
+            : "Папка languages пуста или не найдены JSON файлы");
         overlay->deleteLater();
         this->setGraphicsEffect(nullptr);
         return;
@@ -563,7 +972,7 @@ void Window::ShowWordSetDialog() {
     QDialog dialog(this);
     dialog.setWindowTitle("Выберите набор слов");
     dialog.setModal(true);
-    dialog.setFixedSize(350, 450);
+    dialog.setFixedSize(kWordSetDialogWidth, kWordSetDialogHeight);
 
     dialog.setStyleSheet(R"(
         QDialog {
@@ -584,24 +993,39 @@ void Window::ShowWordSetDialog() {
             border: 1px solid #88c0d0;
             background-color: #434c5e;
         }
-        QListWidget {
+        QComboBox {
+            background-color: #3b4252;
+            border: 1px solid #4c566a;
+            border-radius: 5px;
+            padding: 6px 8px;
+            color: #eceff4;
+            font-size: 14px;
+            margin-bottom: 10px;
+        }
+        QTreeWidget, QListWidget {
             background-color: #3b4252;
             border: 1px solid #4c566a;
             border-radius: 5px;
             color: #eceff4;
             font-size: 14px;
         }
-        QListWidget::item {
+        QTreeWidget::item, QListWidget::item {
             padding: 8px 12px;
             border-radius: 3px;
         }
-        QListWidget::item:selected {
+        QTreeWidget::item:selected {
             background-color: #81a1c1;
             color: #2e3440;
         }
-        QListWidget::item:hover {
+        QTreeWidget::item:hover {
             background-color: #5e81ac;
         }
+        QHeaderView::section {
+            background-color: #434c5e;
+            color: #d8dee9;
+            border: none;
+            padding: 6px 8px;
+        }
         QScrollBar:vertical {
             background: #3b4252;
             width: 10px;
@@ -620,85 +1044,122 @@ void Window::ShowWordSetDialog() {
 
     QVBoxLayout layout(&dialog);
 
-    // Поисковое поле
+    // Поиск и фильтр по языку
+    QHBoxLayout *filterLayout = new QHBoxLayout();
     QLineEdit *searchEdit = new QLineEdit(&dialog);
-    searchEdit->setPlaceholderText("Поиск...");
-    layout.addWidget(searchEdit);
+    searchEdit->setPlaceholderText("Поиск набора или слова...");
+    filterLayout->addWidget(searchEdit, 1);
 
-    // Список наборов слов
-    QListWidget *listWidget = new QListWidget(&dialog);
-    for (const QFileInfo &fileInfo : fileList) {
-        QString name = fileInfo.completeBaseName();
+    QComboBox *languageFilter = new QComboBox(&dialog);
+    languageFilter->addItem("Все языки", QString());
+    for (const QString &language : wordCatalog_.languages()) {
+        languageFilter->addItem(language, language);
+    }
+    filterLayout->addWidget(languageFilter);
+    layout.addLayout(filterLayout);
+
+    // Таблица наборов: числовые колонки сортируются как числа по клику на заголовок
+    QTreeWidget *setsWidget = new QTreeWidget(&dialog);
+    setsWidget->setRootIsDecorated(false);
+    setsWidget->setHeaderLabels({ "Набор", "Язык", "Слов", "Макс. длина", "Письменность" });
+    for (const WordSetInfo &info : sets) {
+        QString name = QFileInfo(info.fileName).completeBaseName();
         name.replace('_', ' ');
-        listWidget->addItem(name);
+
+        QTreeWidgetItem *item = new QTreeWidgetItem(setsWidget);
+        item->setText(0, name);
+        item->setText(1, info.language);
+        item->setData(2, Qt::DisplayRole, info.wordCount);
+        item->setData(3, Qt::DisplayRole, info.maxWordLength);
+        item->setText(4, info.script);
+        item->setData(0, Qt::UserRole, info.fileName);
+    }
+    setsWidget->setSortingEnabled(true);
+    setsWidget->sortByColumn(0, Qt::AscendingOrder);
+    setsWidget->header()->setSectionResizeMode(0, QHeaderView::Stretch);
+    layout.addWidget(setsWidget);
+
+    // Сколько памяти занимает текущий набор по сравнению со списком строк
+    if (currentWords_) {
+        QLabel *memoryLabel = new QLabel(WordListMemoryReport(), &dialog);
+        memoryLabel->setWordWrap(true);
+        layout.addWidget(memoryLabel);
     }
-    layout.addWidget(listWidget);
 
-    // Фильтрация списка по поиску
-    connect(searchEdit, &QLineEdit::textChanged, this, [listWidget](const QString &text){
-        QString filter = text.trimmed();
-        for (int i = 0; i < listWidget->count(); ++i) {
-            QListWidgetItem *item = listWidget->item(i);
-            bool match = item->text().contains(filter, Qt::CaseInsensitive);
-            item->setHidden(!match);
-        }
+    // Слова из всех наборов, начинающиеся с введенного текста
+    QListWidget *wordHitsWidget = new QListWidget(&dialog);
+    wordHitsWidget->setMaximumHeight(kWordHitsHeight);
+    wordHitsWidget->hide();
+    layout.addWidget(wordHitsWidget);
+
+    // Наборы, упорядоченные по частоте, можно выбирать с распределением реальной речи
+    QCheckBox *frequencyCheck = new QCheckBox("Учитывать частоту слов", &dialog);
+    frequencyCheck->setChecked(frequencyWeighted_);
+    layout.addWidget(frequencyCheck);
+    connect(frequencyCheck, &QCheckBox::toggled, this, [this](bool checked) {
+        frequencyWeighted_ = checked;
     });
 
-    // Обработка выбора набора слов
-    connect(listWidget, &QListWidget::itemClicked, &dialog, [&](QListWidgetItem *item) {
-        QString fileName = item->text();
-        fileName.replace(' ', '_') += ".json";
-        dialog.accept();
-
-        QString fullPath = languagesPath + '/' + fileName;
-        QFile file(fullPath);
-        if (!file.open(QIODevice::ReadOnly)) {
-            QMessageBox::warning(this, "Ошибка", "Не удалось открыть файл " + fileName);
-            return;
-        }
-
-        QByteArray jsonData = file.readAll();
-        file.close();
-
-        QJsonParseError parseError;
-        QJsonDocument doc = QJsonDocument::fromJson(jsonData, &parseError);
-        if (parseError.error != QJsonParseError::NoError) {
-            QMessageBox::warning(this, "Ошибка", "Ошибка парсинга JSON: " + parseError.errorString());
-            return;
-        }
-
-        QStringList wordsList;
+    QHBoxLayout *countLayout = new QHBoxLayout();
+    countLayout->addWidget(new QLabel("Слов в тексте:", &dialog));
+    QSpinBox *countSpin = new QSpinBox(&dialog);
+    countSpin->setRange(1, kMaxWordSelection);
+    countSpin->setValue(wordCount_);
+    countSpin->setFixedWidth(kSpinBoxWidth);
+    countLayout->addWidget(countSpin);
+    countLayout->addStretch();
+    layout.addLayout(countLayout);
+    connect(countSpin, &QSpinBox::valueChanged, this, [this](int value) {
+        wordCount_ = value;
+    });
 
-        // Парсим слова из JSON
-        if (doc.isArray()) {
-            for (const QJsonValue &val : doc.array()) {
-                if (val.isString())
-                    wordsList.append(val.toString());
+    // Пока индекс строится, поиск идет только по именам наборов
+    if (searchIndexStale_) {
+        RebuildSearchIndex();
+    }
+    auto applyFilter = [this, setsWidget, searchEdit, languageFilter, wordHitsWidget]() {
+        const QString filter = searchEdit->text().trimmed();
+        const QString language = languageFilter->currentData().toString();
+        const QSharedPointer<const WordSearchIndex> searchIndex = searchIndex_;
+
+        // Набор подходит, если совпадает его имя или в нем есть слово с таким началом.
+        // Список слов ограничен, а наборы собираются по всем совпадениям
+        QSet<QString> setsWithWord;
+        wordHitsWidget->clear();
+        if (searchIndex && !filter.isEmpty()) {
+            for (int set : searchIndex->setsWithPrefix(filter)) {
+                setsWithWord.insert(searchIndex->setNames().at(set));
             }
-        } else if (doc.isObject()) {
-            QJsonObject obj = doc.object();
-            if (obj.contains("words") && obj.value("words").isArray()) {
-                for (const QJsonValue &val : obj.value("words").toArray()) {
-                    if (val.isString())
-                        wordsList.append(val.toString());
-                }
-            } else {
-                for (auto it = obj.begin(); it != obj.end(); ++it) {
-                    if (it.value().isString())
-                        wordsList.append(it.value().toString());
+            for (const WordSearchHit &hit : searchIndex->search(filter, kWordSearchLimit)) {
+                QStringList names;
+                for (int set : hit.sets) {
+                    names.append(searchIndex->setNames().at(set));
                 }
+                wordHitsWidget->addItem(hit.word + " — " + names.join(", "));
             }
         }
+        wordHitsWidget->setVisible(wordHitsWidget->count() > 0);
 
-        if (wordsList.isEmpty()) {
-            QMessageBox::warning(this, "Ошибка", "В файле нет слов для генерации");
-            return;
+        for (int i = 0; i < setsWidget->topLevelItemCount(); ++i) {
+            QTreeWidgetItem *item = setsWidget->topLevelItem(i);
+            const QString setName = QFileInfo(item->data(0, Qt::UserRole).toString()).completeBaseName();
+            const bool match = (item->text(0).contains(filter, Qt::CaseInsensitive) || setsWithWord.contains(setName))
+                && (language.isEmpty() || item->text(1) == language);
+            item->setHidden(!match);
         }
+    };
+    connect(searchEdit, &QLineEdit::textChanged, this, applyFilter);
+    connect(languageFilter, &QComboBox::currentIndexChanged, this, applyFilter);
+    connect(&searchIndexWatcher_, &QFutureWatcher<QSharedPointer<const WordSearchIndex>>::finished, &dialog, applyFilter);
+    connect(&wordCatalog_, &WordSetCatalog::changed, &dialog, [this]() { RebuildSearchIndex(); });
 
-        currentWordList_ = wordsList;
-        wordsModeActive_ = true;
-        GenerateNewTextFromWordList();
-        typing_allowed_ = true;
+    // Обработка выбора набора слов
+    connect(setsWidget, &QTreeWidget::itemClicked, &dialog, [&](QTreeWidgetItem *item) {
+        const QString fileName = item->data(0, Qt::UserRole).toString();
+        dialog.accept();
+
+        // Набор читается в фоне; результат приходит в OnWordListLoaded
+        wordLoader_.load(QDir(wordCatalog_.directory()).filePath(fileName));
     });
 
     // Центрируем диалог
@@ -714,25 +1175,334 @@ void Window::ShowWordSetDialog() {
     overlay->deleteLater();
 }
 
+void Window::OnWordListLoaded(const WordPackPtr &words) {
+    CancelAiGeneration();
+    currentWords_ = words;
+    ngramIndex_.reset();
+    RebuildNgramIndex();
+    pipelineLanguage_ = currentWords_->name();
+    RebuildTextPipeline();
+    if (currentWords_->orderedByFrequency()) {
+        sampler_.build(*currentWords_);
+    } else {
+        sampler_.clear();
+    }
+    wordsModeActive_ = true;
+    bookModeActive_ = false;
+    GenerateNewTextFromWordList();
+    typing_allowed_ = true;
+}
+
+QString Window::WordListMemoryReport() const {
+    const WordPack &words = *currentWords_;
+    const auto kb = [](qint64 bytes) { return QString::number((bytes + 1023) / 1024); };
+    return QString("%1: %2 слов, в куче %3 КБ%4 (как QStringList ≈ %5 КБ); кеш наборов %6 КБ")
+        .arg(words.name())
+        .arg(words.count())
+        .arg(kb(words.heapBytes()))
+        .arg(words.isMapped() ? ", файл " + kb(words.imageSize()) + " КБ отображен в память" : QString())
+        .arg(kb(words.stringListBytes()))
+        .arg(kb(wordLoader_.cachedBytes()));
+}
+
 void Window::GenerateNewTextFromWordList() {
-    if (currentWordList_.isEmpty()) {
+    if (!currentWords_ || currentWords_->isEmpty()) {
+        return;
+    }
+    if (timedModeActive_) {
+        StartTimedTest();
+        return;
+    }
+
+    // Адаптивный режим берет слова со слабыми местами пользователя; пока статистики нет,
+    // текст собирается обычным образом. Частотная выборка допускает повторы, как в обычном тексте
+    QRandomGenerator &rng = *QRandomGenerator::global();
+    QString text = adaptiveModeActive_ ? GenerateAdaptiveText(rng) : QString();
+    if (text.isEmpty()) {
+        text = frequencyWeighted_ && !sampler_.isEmpty()
+            ? wordSelector_.selectWeighted(*currentWords_, sampler_, wordCount_, rng)
+            : wordSelector_.selectUniform(*currentWords_, wordCount_, rng);
+    }
+    text = ApplyTextPipeline(text);
+
+    generated_text_->setTargetText(text);
+    ResetText();
+}
+
+void Window::RebuildSearchIndex() {
+    searchIndexStale_ = false;
+    if (searchIndexWatcher_.isRunning()) {
+        searchIndexQueued_ = true;
+        return;
+    }
+
+    QStringList paths;
+    for (const WordSetInfo &info : wordCatalog_.entries()) {
+        paths.append(QDir(wordCatalog_.directory()).filePath(info.fileName));
+    }
+    searchIndexWatcher_.setFuture(QtConcurrent::run(&WordSearchIndex::build, paths));
+}
+
+QString Window::GenerateAdaptiveText(QRandomGenerator &rng) {
+    // Индекс набора еще строится в фоне
+    if (keyStats_.isEmpty() || !ngramIndex_) {
+        return QString();
+    }
+
+    // Статистика общая для всех языков: слабые места, которых нет в наборе, отбрасываются
+    // до отбора лучших, иначе после смены языка все цели могут оказаться чужими
+    const NgramIndex &index = *ngramIndex_;
+    const QVector<WeakSpot> spots = keyStats_.weakest(kAdaptiveWeakSpots, kAdaptiveMinSamples,
+        [&index](quint64 key) { return index.find(key).size() > 0; });
+    if (spots.isEmpty()) {
+        return QString();
+    }
+
+    QVector<NgramWeight> targets;
+    targets.reserve(spots.size());
+    for (const WeakSpot &spot : spots) {
+        targets.append({ spot.key, spot.score });
+    }
+    return wordSelector_.selectTargeted(*currentWords_, index, targets, wordCount_, rng);
+}
+
+void Window::RebuildNgramIndex() {
+    // Индекс нужен только адаптивному режиму; пока он выключен, память не тратится
+    if (!adaptiveModeActive_ || !currentWords_ || ngramIndex_ || ngramIndexWatcher_.isRunning()) {
         return;
     }
+    ngramIndexWords_ = currentWords_;
+    const WordPackPtr words = currentWords_;
+    ngramIndexWatcher_.setFuture(QtConcurrent::run([words]() {
+        auto index = QSharedPointer<NgramIndex>::create();
+        index->build(*words);
+        return QSharedPointer<const NgramIndex>(index);
+    }));
+}
 
-    QStringList newSelection;
-    QSet<int> usedIndices;
-    int count = std::min(15, int(currentWordList_.size()));
+bool Window::IsTimedTest() const {
+    return timedModeActive_ && wordsModeActive_ && currentWords_;
+}
+
+void Window::ShowTimeMenu() {
+    QMenu menu(this);
+    for (int seconds : kTimedDurationsSec) {
+        QAction *action = menu.addAction(QString("%1 с").arg(seconds));
+        action->setCheckable(true);
+        action->setChecked(timedModeActive_ && timedDurationSec_ == seconds);
+        connect(action, &QAction::triggered, this, [this, seconds]() {
+            timedModeActive_ = true;
+            timedDurationSec_ = seconds;
+        });
+    }
+    menu.addSeparator();
+    QAction *off = menu.addAction("Без времени");
+    connect(off, &QAction::triggered, this, [this]() { timedModeActive_ = false; });
 
-    while (newSelection.size() < count) {
-        int index = QRandomGenerator::global()->bounded(currentWordList_.size());
-        if (!usedIndices.contains(index)) {
-            usedIndices.insert(index);
-            newSelection.append(currentWordList_.at(index));
+    if (menu.exec(QCursor::pos()) == nullptr) {
+        return;
+    }
+    if (!currentWords_) {
+        if (timedModeActive_) {
+            QMessageBox::information(this, "Время", "Выберите набор слов — тест на время строится из него");
         }
+        return;
     }
+    CancelAiGeneration();
+    wordsModeActive_ = true;
+    bookModeActive_ = false;
+    GenerateNewTextFromWordList();
+}
 
-    generated_text_->setText(newSelection.join(' '));
+QString Window::GenerateTimedWords(int words) {
+    PackWordSource source(*currentWords_, frequencyWeighted_ ? &sampler_ : nullptr, *QRandomGenerator::global());
+    QString text;
+    textPipeline_.run(source, text, words, *QRandomGenerator::global());
+    return text;
+}
+
+void Window::StartTimedTest() {
+    textPipeline_.resetContext();
+    generated_text_->setTargetText(GenerateTimedWords(kTimedInitialWords));
     ResetText();
+    typing_allowed_ = true;
+    statusLabel_->setText(QString("Тест на %1 с начнется с первого нажатия").arg(timedDurationSec_));
+}
+
+void Window::AdvanceTimedText() {
+    // Набранные строки уходят из сессии и раскладки, оставляя одну строку над кареткой;
+    // впереди текст дописывается порциями, так что окно и стоимость нажатия не растут
+    const int index = session_.currentIndex();
+    const int caret = index < session_.length() ? session_.clusterStart(index) : session_.targetText().length();
+    const int line = generated_text_->lineAt(caret);
+    const int retired = line > kTimedKeepLines ? generated_text_->lineStart(line - kTimedKeepLines) : 0;
+    const int ahead = session_.targetText().length() - caret;
+    if (retired == 0 && ahead >= kTimedLookaheadChars / 2) {
+        return;
+    }
+
+    QString appended;
+    while (ahead + appended.length() < kTimedLookaheadChars) {
+        appended += ' ';
+        appended += GenerateTimedWords(kTimedChunkWords);
+    }
+
+    session_.retire(session_.clusterIndexAt(retired));
+    session_.append(appended);
+    generated_text_->scrollText(retired, appended);
+}
+
+void Window::RebuildTextPipeline() {
+    // Заглавные буквы идут в паре с пунктуацией: без концов предложений им не на что опираться
+    textPipeline_.clear();
+    prosePipeline_.clear();
+    if (punctuationEnabled_) {
+        textPipeline_.addStage(std::make_unique<CapitalizeTransform>());
+        textPipeline_.addStage(std::make_unique<PunctuationTransform>(PunctuationStyleFor(pipelineLanguage_)));
+    }
+    // В связном тексте пунктуация уже есть, поэтому к нему добавляются только числа
+    if (numbersEnabled_) {
+        textPipeline_.addStage(std::make_unique<NumbersTransform>());
+        prosePipeline_.addStage(std::make_unique<NumbersTransform>());
+    }
+}
+
+QString Window::ApplyTextPipeline(const QString& text) {
+    if (textPipeline_.isEmpty()) {
+        return text;
+    }
+    return textPipeline_.transform(text, *QRandomGenerator::global());
+}
+
+QString Window::ApplyProsePipeline(const QString& text, bool continued) {
+    if (prosePipeline_.isEmpty()) {
+        return text;
+    }
+    if (!continued) {
+        return prosePipeline_.transform(text, *QRandomGenerator::global());
+    }
+
+    // Продолжение потока: контекст сохраняется, а ведущий пробел,
+    // который run() у первого слова отбрасывает, возвращается на место
+    qsizetype lead = 0;
+    while (lead < text.size() && text.at(lead).isSpace()) {
+        ++lead;
+    }
+    QString out;
+    TextWordSource source(text);
+    prosePipeline_.run(source, out, std::numeric_limits<int>::max(), *QRandomGenerator::global());
+    return out.isEmpty() ? out : text.left(lead) + out;
+}
+
+void Window::TogglePunctuation() {
+    punctuationEnabled_ = !punctuationEnabled_;
+    RebuildTextPipeline();
+    if (wordsModeActive_) {
+        GenerateNewTextFromWordList();
+    }
+}
+
+void Window::ToggleNumbers() {
+    numbersEnabled_ = !numbersEnabled_;
+    RebuildTextPipeline();
+    if (wordsModeActive_) {
+        GenerateNewTextFromWordList();
+    }
+}
+
+void Window::ToggleAdaptiveMode() {
+    adaptiveModeActive_ = !adaptiveModeActive_;
+    RebuildNgramIndex();
+    if (wordsModeActive_) {
+        GenerateNewTextFromWordList();
+    }
+    statusLabel_->setText(adaptiveModeActive_
+        ? "Адаптивный режим: слова со слабыми символами и биграммами"
+        : "Адаптивный режим выключен");
+}
+
+void Window::ShowGhostDialog() {
+    if (currentUsername_.isEmpty()) {
+        QMessageBox::information(this, "Инфо", "Сначала войдите в систему");
+        return;
+    }
+
+    const QVector<TypingRecordingInfo> recordings =
+        database_.getTypingRecordingsForUser(currentUsername_, kGhostRecordingsLimit);
+    if (recordings.isEmpty()) {
+        QMessageBox::information(this, "Заезд", "Нет записанных сессий");
+        return;
+    }
+
+    QDialog dialog(this);
+    dialog.setWindowTitle("Выберите заезд");
+    dialog.setModal(true);
+    dialog.setFixedSize(kLanguageChoiceWidth, kLanguageChoiceHeight);
+
+    QVBoxLayout layout(&dialog);
+    QListWidget list_widget(&dialog);
+
+    for (const TypingRecordingInfo &info : recordings) {
+        auto item = new QListWidgetItem(QString("%1 — %2 WPM")
+            .arg(info.session_date.toString("dd.MM.yyyy hh:mm"))
+            .arg(QString::number(info.wpm, 'f', 1)));
+        item->setData(Qt::UserRole, info.session_id);
+        list_widget.addItem(item);
+    }
+
+    int session_id = -1;
+    connect(&list_widget, &QListWidget::itemClicked, this, [&dialog, &session_id](QListWidgetItem* item) {
+        session_id = item->data(Qt::UserRole).toInt();
+        dialog.accept();
+    });
+
+    layout.addWidget(&list_widget);
+    dialog.exec();
+
+    QString text;
+    QByteArray keystrokes;
+    if (session_id < 0 || !database_.getTypingRecording(session_id, text, keystrokes)) {
+        return;
+    }
+
+    CancelAiGeneration();
+    wordsModeActive_ = false;
+    bookModeActive_ = false;
+    // Заезд идет по тексту записи без пайплайна: нажатия записаны именно по нему
+    generated_text_->setTargetText(text);
+    ResetText();
+
+    // Призрак стартует вместе с первым нажатием пользователя
+    ghostKeys_ = KeystrokeRecorder::decode(keystrokes, text);
+    generated_text_->setGhostCaret(0);
+    typing_allowed_ = true;
+}
+
+void Window::StopGhost() {
+    ghostTimer_->stop();
+    ghostKeys_.clear();
+    ghostKeyIndex_ = 0;
+    ghostCaret_ = 0;
+    generated_text_->setGhostCaret(-1);
+}
+
+void Window::AdvanceGhost() {
+    const qint64 elapsed_ms = (keyClock_.nsecsElapsed() - raceStartNs_) / 1000000;
+
+    while (ghostKeyIndex_ < ghostKeys_.size() && ghostKeys_[ghostKeyIndex_].offsetMs <= elapsed_ms) {
+        if (ghostKeys_[ghostKeyIndex_].kind == KeystrokeKind::Backspace) {
+            ghostCaret_ = qMax(ghostCaret_ - 1, 0);
+        } else {
+            ++ghostCaret_;
+        }
+        ++ghostKeyIndex_;
+    }
+
+    generated_text_->setGhostCaret(ghostCaret_ < session_.length() ? session_.clusterStart(ghostCaret_)
+                                                                    : session_.targetText().length());
+    if (ghostKeyIndex_ == ghostKeys_.size()) {
+        ghostTimer_->stop();
+    }
 }
 
 void Window::ShowStats() {
@@ -858,8 +1628,27 @@ void Window::ShowStats() {
     checkBoxLayout->addWidget(cbAvg);
     checkBoxLayout->addStretch();
 
+    // Кэш ответов AI: сколько текстов сохранено и как часто запрос обходился без сети
+    const AiCacheStats aiCache = database_.getAiCacheStats();
+    const qint64 aiLookups = aiCache.hits + aiCache.misses;
+    QLabel *aiCacheLabel = new QLabel(QString("Кэш AI: %1 текстов, из них новых %2 | попаданий %3 из %4 (%5%)")
+        .arg(aiCache.entries)
+        .arg(aiCache.unused)
+        .arg(aiCache.hits)
+        .arg(aiLookups)
+        .arg(aiLookups > 0 ? kHundred * aiCache.hits / aiLookups : 0), dialog);
+    aiCacheLabel->setStyleSheet("color: #d8dee9; font-size: 14px;");
+    checkBoxLayout->addWidget(aiCacheLabel);
+
     mainLayout->addLayout(checkBoxLayout);
-    mainLayout->addWidget(chartView);
+
+    // График и тепловая карта клавиш рядом
+    QHBoxLayout *chartLayout = new QHBoxLayout();
+    chartLayout->addWidget(chartView, 1);
+    if (!keyStats_.isEmpty()) {
+        chartLayout->addWidget(new KeyboardHeatmap(keyStats_, dialog), 0, Qt::AlignTop);
+    }
+    mainLayout->addLayout(chartLayout);
 
     // Слот для обновления видимости линий по чекбоксам
     auto updateVisibility = [series, movingAvgSeries, cbRaw, cbAvg]() {
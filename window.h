@@ -14,6 +14,7 @@
 #include <QLabel>
 #include <QListWidget>
 #include <QMenu>
+#include <QCursor>
 #include <QMessageBox>
 #include <QPropertyAnimation>
 #include <QPushButton>
@@ -21,6 +22,8 @@
 #include <QSpinBox>
 #include <QString>
 #include <QTextEdit>
+#include <QTreeWidget>
+#include <QHeaderView>
 #include <QToolButton>
 #include <QCheckBox>
 #include <QColorDialog>
@@ -29,17 +32,38 @@
 #include <QtCharts/QDateTimeAxis>
 #include <QtCharts/QValueAxis>
 #include <QTimer>
+#include <QElapsedTimer>
 #include <QJsonArray>
 #include <QJsonParseError>
 #include <QJsonObject>
 #include <QRandomGenerator>
+#include <QRegularExpression>
+#include <QDebug>
+#include <QDir>
+#include <QSysInfo>
+#include <QFutureWatcher>
+#include <QtConcurrent/QtConcurrentRun>
 
 // Project Includes
 #include "AI json-request/api.h"
+#include "aiprefetchqueue.h"
+#include "aitextgenerator.h"
 #include "src/languages.h"
 #include "database.h"
 #include "logindialog.h"
 #include "settingswidget.h"
+#include "bookreader.h"
+#include "keyboardheatmap.h"
+#include "keylatencystats.h"
+#include "latencyhistogram.h"
+#include "typingsession.h"
+#include "textpipeline.h"
+#include "typingview.h"
+#include "wordlistloader.h"
+#include "wordsampler.h"
+#include "wordselector.h"
+#include "wordsearchindex.h"
+#include "wordsetcatalog.h"
 
 // Constants
 constexpr int kWindowSize = 1600;
@@ -50,6 +74,30 @@ constexpr int kLanguageChoiceWidth = 450;
 constexpr int kLanguageChoiceHeight = 600;
 constexpr int kWordsNumber = 100;
 
+constexpr int kDefaultWordSelection = 15;
+constexpr int kMaxWordSelection = 5000;
+
+constexpr int kAdaptiveWeakSpots = 12;
+constexpr quint32 kAdaptiveMinSamples = 5;
+
+constexpr int kWordSearchLimit = 30;
+constexpr int kWordHitsHeight = 120;
+
+constexpr int kTimedDurationsSec[] = {15, 30, 60, 120};
+constexpr int kDefaultTimedDurationSec = 30;
+constexpr int kTimedInitialWords = 60;
+constexpr int kTimedChunkWords = 16;
+constexpr int kTimedLookaheadChars = 400;
+constexpr int kTimedKeepLines = 1;
+
+constexpr int kWordSetDialogWidth = 640;
+constexpr int kWordSetDialogHeight = 480;
+
+// Наборы слов и иконки встроены в исполняемый файл (см. qt_add_resources в CMakeLists.txt).
+// Наборы встроены только как .kwp, собранные из languages/*.json при сборке; они лежат
+// несжатыми, чтобы отображаться в память прямо из образа программы
+inline const QString kWordPacksPath = ":/packs";
+
 constexpr int kDefaultLineHeight = 20;
 constexpr int kIntervalMs = 200;
 
@@ -60,6 +108,8 @@ constexpr int kTextFieldMinimumHeight = 100;
 constexpr int kSpinBoxWidth = 72;
 
 constexpr int kDefaultLetterSpacing = 2;
+constexpr int kDefaultFontSize = 16;
+constexpr int kDefaultFontWeight = 500;
 constexpr int kDefaultWordSpacing = 2;
 
 constexpr int kMinFontWeight = 100;
@@ -76,11 +126,17 @@ constexpr int kLineHeightStep = 2;
 constexpr int kMaxLetterSpacing = 12;
 constexpr int kMaxWordSpacing = 24;
 
+constexpr qint64 kBookModeThresholdBytes = 64 * 1024;
+
+constexpr int kGhostFrameMs = 16;
+constexpr int kPendingInputsReserve = 64;
+constexpr int kGhostRecordingsLimit = 50;
+
 constexpr int kAnimationDurationMs = 400;
+constexpr int kAiSpinnerIntervalMs = 100;
+constexpr int kAiCacheMaxEntries = 500;
 constexpr int kTypingIntervalMs = 200;
 
-constexpr double kUpdateIntervalSec = 0.2;
-constexpr double kSecondsInMinute = 60.0;
 
 constexpr int kFontButtonWidth = 180;
 
@@ -92,8 +148,6 @@ constexpr int kMainLayoutSpacing = 15;
 constexpr int kColorButtonWidth = 100;
 constexpr int kColorButtonHeight = 30;
 
-constexpr double kWpmCoefficient = 4.5;
-
 const std::string kPromptTemplatePart1 =
     "Please find a random article about programming(c++, python, variables, "
     "etc.). Summarize the key tips and highlights presented in the article. "
@@ -117,6 +171,8 @@ public:
 
 protected:
     void keyPressEvent(QKeyEvent* event) override;
+    void inputMethodEvent(QInputMethodEvent* event) override;
+    QVariant inputMethodQuery(Qt::InputMethodQuery query) const override;
 
 private slots:
     // User interaction
@@ -129,6 +185,7 @@ private slots:
     void ShowSettings();
     void ShowWordSetDialog();
     void ShowStats();
+    void ShowGhostDialog();
     void random();
 
 private:
@@ -138,11 +195,50 @@ private:
     void StartTypingTimer();
     void StopTypingTimer();
     void UpdateWPM();
+    void TypeText(const QString& text, qint64 timestamp);
+    void UpdateCaret();
+    void FinishSession();
+    static QString AiRequest(const QString& language);
+    static AiCacheKey AiCacheKeyFor(const QString& language);
+    void OnAiTextReady(const QString& language, const QString& text, bool streaming = false);
+    void OnAiTextPartial(const QString& delta);
+    void ReleaseAiStream(bool all);
+    void FinishAiStream();
+    void OnAiTextFailed(const QString& error);
+    void CancelAiGeneration();
+    void UpdateAiSpinner();
+    void MarkInputPending(qint64 timestamp);
+    void RecordInputLatency();
+    void UpdateLatencyOverlay();
+    void DumpInputLatency() const;
+    void ShowScore(double raw_wpm, double accuracy, double wpm);
     void GenerateNewTextFromWordList();
+    void OnWordListLoaded(const WordPackPtr& words);
+    QString GenerateAdaptiveText(QRandomGenerator& rng);
+    void RebuildNgramIndex();
+    void RebuildSearchIndex();
+    QString WordListMemoryReport() const;
+    void ToggleAdaptiveMode();
+    void RebuildTextPipeline();
+    QString ApplyTextPipeline(const QString& text);
+    QString ApplyProsePipeline(const QString& text, bool continued = false);
+    void TogglePunctuation();
+    bool IsTimedTest() const;
+    void ShowTimeMenu();
+    QString GenerateTimedWords(int words);
+    void StartTimedTest();
+    void AdvanceTimedText();
+    void ToggleNumbers();
+    void StopGhost();
+    void OpenBook(const QString& path);
+    void ShowBookPage();
+    void AdvanceBookPage();
+    void AdvanceGhost();
 
     // UI elements
-    QLabel* generated_text_;
+    TypingView* generated_text_;
     QLabel* statusLabel_;
+    QLabel* latencyLabel_;
     QLabel* usernameLabel_;
     SettingsWidget *settingsWidget_;
     QSvgWidget* accountIconLabel;
@@ -153,30 +249,87 @@ private:
 
     // Typing state variables
     QString prompt_language_;
-    QString targetText_;
-    QVector<QChar> typedChars_;
-    QVector<bool> errorFlags_;
-
-    int currentIndex_ = 0;
-    int errorCount_ = 0;
-    int typedCharCount_ = 0;
-
+    AiTextGenerator aiGenerator_;
+    // Язык запроса в aiGenerator_: ответ относится к нему, даже если язык уже сменили
+    QString aiRequestLanguage_;
+    // Готовые тексты AI для выбранного языка, сгенерированные заранее
+    AiPrefetchQueue aiPrefetch_;
+    // Потоковый ответ: набор идет по уже пришедшему тексту, хвост ждет конца слова
+    bool aiStreaming_ = false;
+    QString aiStreamBuffer_;
+    QTimer* aiSpinnerTimer_;
+    int aiSpinnerFrame_ = 0;
+    TypingSession session_;
+
+    // Монотонные часы для отметок нажатий; WPM и точность считаются по ленте
+    QElapsedTimer keyClock_;
     QTimer* typing_timer_;
-    double elapsed_seconds_ = 0;
     bool typing_allowed_ = false;
 
+    // Время от прихода нажатия до окончания перерисовки поля набора
+    LatencyHistogram inputLatency_;
+    QVector<qint64> pendingInputsNs_;
+
+    // Задержки по клавишам и биграммам, накопленные за все сессии пользователя
+    KeyLatencyStats keyStats_;
+
+    // Заезд против записи прошлой сессии
+    QVector<RecordedKeystroke> ghostKeys_;
+    int ghostKeyIndex_ = 0;
+    int ghostCaret_ = 0;
+    qint64 raceStartNs_ = 0;
+    QTimer* ghostTimer_;
+
     // User session info
     QString currentUsername_;
     Database &database_;
 
+    // Режим книги: большой файл отображается в память и набирается постранично
+    BookReader book_;
+    bool bookModeActive_ = false;
+    qint64 bookOffset_ = 0;
+    qint64 bookNextOffset_ = 0;
+
     // Visual & Formatting state
     bool wordsModeActive_ = false;
-    QStringList currentWordList_;
+    WordSetCatalog wordCatalog_;
+    // Поиск слов по всем наборам; пока индекс строится, ищется только по именам
+    QSharedPointer<const WordSearchIndex> searchIndex_;
+    QFutureWatcher<QSharedPointer<const WordSearchIndex>> searchIndexWatcher_;
+    bool searchIndexQueued_ = false;
+    bool searchIndexStale_ = true;
+    WordListLoader wordLoader_;
+    WordPackPtr currentWords_;
+    // Таблица псевдонимов для частотной выборки; пуста, если набор не упорядочен по частоте
+    WordSampler sampler_;
+    bool frequencyWeighted_ = false;
+    WordSelector wordSelector_;
+    // Тест на время: окно текста сдвигается вслед за кареткой
+    bool timedModeActive_ = false;
+    int timedDurationSec_ = kDefaultTimedDurationSec;
+    QTimer* timedTimer_;
+
+    // Пунктуация и числа поверх текста из любого источника
+    bool punctuationEnabled_ = false;
+    bool numbersEnabled_ = false;
+    QString pipelineLanguage_;
+    TextPipeline textPipeline_;
+    // Для связного текста (файл, книга, AI): только числа
+    TextPipeline prosePipeline_;
+
+    // Адаптивный режим: обратный индекс символов и биграмм текущего набора.
+    // Строится в фоне, пока режим включен; до готовности текст собирается обычным образом
+    bool adaptiveModeActive_ = false;
+    QSharedPointer<const NgramIndex> ngramIndex_;
+    QFutureWatcher<QSharedPointer<const NgramIndex>> ngramIndexWatcher_;
+    // Набор, для которого строится индекс в ngramIndexWatcher_
+    WordPackPtr ngramIndexWords_;
+    int wordCount_ = kDefaultWordSelection;
 
     int letterSpacing_ = kDefaultLetterSpacing;
     int wordSpacing_ = kDefaultWordSpacing;
-    int fontWeight_;
-    int fontSize_;
+    int fontWeight_ = kDefaultFontWeight;
+    int fontSize_ = kDefaultFontSize;
     int lineHeight_ = kDefaultLineHeight;
     QString caretSmooth_;
     QString caretStyle_;
@@ -189,7 +342,7 @@ private:
     };
 
     QFont currentFont_;
-    QColor textColor_ = Qt::white;
+    QColor textColor_ = QColor("#eceff4");
 };
 
 #endif // WINDOW_H
\ No newline at end of file
@@ -0,0 +1,82 @@
+#include "wordlistloader.h"
+#include <QDateTime>
+#include <QFileInfo>
+#include <QtConcurrent/QtConcurrentRun>
+
+namespace {
+constexpr qint64 kDefaultCacheLimitBytes = 64 * 1024 * 1024;
+
+int CostKb(const WordPack &words) {
+    return int(qMax<qint64>(1, words.imageSize() / 1024));
+}
+}
+
+WordListLoader::WordListLoader(QObject *parent) : QObject(parent) {
+    setCacheLimitBytes(kDefaultCacheLimitBytes);
+    connect(&watcher_, &QFutureWatcher<Result>::finished, this, &WordListLoader::onFinished);
+}
+
+WordListLoader::~WordListLoader() {
+    watcher_.waitForFinished();
+}
+
+void WordListLoader::setCacheLimitBytes(qint64 bytes) {
+    cache_.setMaxCost(int(qMax<qint64>(1, bytes / 1024)));
+}
+
+void WordListLoader::load(const QString &path) {
+    if (isLoading()) {
+        queuedPath_ = path;
+        return;
+    }
+
+    const QFileInfo source(path);
+    const QString key = source.absoluteFilePath() + '|' + QString::number(source.lastModified().toMSecsSinceEpoch());
+
+    if (WordPackPtr *cached = cache_.object(key)) {
+        ++hits_;
+        emit loaded(*cached);
+        return;
+    }
+
+    ++misses_;
+    pendingKey_ = key;
+    emit loadingStarted(source.completeBaseName());
+    watcher_.setFuture(QtConcurrent::run(&WordListLoader::loadBlocking, path));
+}
+
+WordListLoader::Result WordListLoader::loadBlocking(const QString &path) {
+    Result result;
+    result.words = QSharedPointer<WordPack>::create();
+    if (!QFileInfo::exists(path)) {
+        result.error = "Не удалось открыть файл " + QFileInfo(path).fileName();
+        result.words.reset();
+    } else if (!result.words->openFile(path, &result.error)) {
+        result.error = "Ошибка разбора набора слов: " + result.error;
+        result.words.reset();
+    }
+    return result;
+}
+
+void WordListLoader::onFinished() {
+    const Result result = watcher_.result();
+    const QString key = pendingKey_;
+    pendingKey_.clear();
+
+    if (result.words) {
+        const WordPackPtr words = result.words;
+        cache_.insert(key, new WordPackPtr(words), CostKb(*words));
+        // Если пользователь уже выбрал другой набор, этот только оседает в кеше
+        if (queuedPath_.isEmpty()) {
+            emit loaded(words);
+        }
+    } else if (queuedPath_.isEmpty()) {
+        emit failed(result.error);
+    }
+
+    if (!queuedPath_.isEmpty()) {
+        const QString next = queuedPath_;
+        queuedPath_.clear();
+        load(next);
+    }
+}
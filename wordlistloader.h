@@ -0,0 +1,58 @@
+#ifndef WORDLISTLOADER_H
+#define WORDLISTLOADER_H
+
+#include <QCache>
+#include <QFutureWatcher>
+#include <QObject>
+#include <QSharedPointer>
+#include "wordpack.h"
+
+using WordPackPtr = QSharedPointer<const WordPack>;
+
+// Загружает наборы слов в фоновом потоке и держит последние использованные
+// в LRU-кеше, ограниченном по объему. Ключ кеша — путь и время изменения файла,
+// поэтому измененный на диске набор перечитывается.
+class WordListLoader : public QObject {
+    Q_OBJECT
+
+public:
+    explicit WordListLoader(QObject *parent = nullptr);
+    ~WordListLoader() override;
+
+    // path — скомпилированный .kwp (отображается в память) или JSON (собирается в образ)
+    void load(const QString &path);
+    bool isLoading() const { return !pendingKey_.isEmpty(); }
+
+    void setCacheLimitBytes(qint64 bytes);
+
+    // Объем образов в кеше (для отображенных файлов это не куча, а адресное пространство)
+    qint64 cachedBytes() const { return qint64(cache_.totalCost()) * 1024; }
+
+    int cacheHits() const { return hits_; }
+    int cacheMisses() const { return misses_; }
+
+signals:
+    void loadingStarted(const QString &name);
+    void loaded(const WordPackPtr &words);
+    void failed(const QString &error);
+
+private:
+    struct Result {
+        QSharedPointer<WordPack> words;
+        QString error;
+    };
+
+    static Result loadBlocking(const QString &path);
+    void onFinished();
+
+    // Стоимость элемента — размер образа в килобайтах
+    QCache<QString, WordPackPtr> cache_;
+    QFutureWatcher<Result> watcher_;
+    QString pendingKey_;
+    // Выбор, сделанный во время загрузки, запускается после нее
+    QString queuedPath_;
+    int hits_ = 0;
+    int misses_ = 0;
+};
+
+#endif // WORDLISTLOADER_H
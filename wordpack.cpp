@@ -0,0 +1,249 @@
+#include "wordpack.h"
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonParseError>
+#include <QVector>
+#include <cstring>
+
+namespace {
+constexpr int kAlignment = 4;
+
+void AppendU32(QByteArray &out, quint32 value) {
+    // Формат рассчитан на little-endian платформы, на которых собирается тренажер
+    out.append(reinterpret_cast<const char *>(&value), sizeof(value));
+}
+
+void AlignTo(QByteArray &out, int alignment) {
+    while (out.size() % alignment != 0) {
+        out.append('\0');
+    }
+}
+
+// Обходит слова документа, не собирая промежуточный список строк
+template <typename Visit>
+void ForEachWord(const QJsonDocument &doc, Visit visit) {
+    auto visitArray = [&visit](const QJsonArray &array) {
+        for (const QJsonValue &val : array) {
+            if (val.isString())
+                visit(val.toString());
+        }
+    };
+    if (doc.isArray()) {
+        visitArray(doc.array());
+    } else if (doc.isObject()) {
+        const QJsonObject obj = doc.object();
+        if (obj.contains("words") && obj.value("words").isArray()) {
+            visitArray(obj.value("words").toArray());
+        } else {
+            for (auto it = obj.begin(); it != obj.end(); ++it) {
+                if (it.value().isString())
+                    visit(it.value().toString());
+            }
+        }
+    }
+}
+}
+
+WordPack::~WordPack() {
+    close();
+}
+
+bool WordPack::open(const QString &path) {
+    close();
+
+    file_.setFileName(path);
+    if (!file_.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    const qint64 size = file_.size();
+    const uchar *data = file_.map(0, size);
+    if (data == nullptr || !attach(data, size)) {
+        close();
+        return false;
+    }
+    mapped_ = true;
+    return true;
+}
+
+bool WordPack::openData(const QByteArray &image) {
+    close();
+    image_ = image;
+    if (!attach(reinterpret_cast<const uchar *>(image_.constData()), image_.size())) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+bool WordPack::openFile(const QString &path, QString *error) {
+    if (path.endsWith(".kwp", Qt::CaseInsensitive)) {
+        if (!open(path)) {
+            *error = "поврежденный или несовместимый .kwp";
+            return false;
+        }
+        return true;
+    }
+
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        *error = "не удалось открыть файл";
+        return false;
+    }
+    const QByteArray image = compileJson(file.readAll(), error);
+    return !image.isEmpty() && openData(image);
+}
+
+void WordPack::close() {
+    if (mapped_ && data_ != nullptr) {
+        file_.unmap(const_cast<uchar *>(data_));
+    }
+    if (file_.isOpen()) {
+        file_.close();
+    }
+    image_.clear();
+    data_ = nullptr;
+    size_ = 0;
+    mapped_ = false;
+    header_ = nullptr;
+    offsets_ = nullptr;
+    ranks_ = nullptr;
+    blob_ = nullptr;
+}
+
+bool WordPack::attach(const uchar *data, qint64 size) {
+    if (size < qint64(sizeof(WordPackHeader))) {
+        return false;
+    }
+
+    const auto *header = reinterpret_cast<const WordPackHeader *>(data);
+    if (std::memcmp(header->magic, kMagic, sizeof(kMagic)) != 0 || header->version != kVersion) {
+        return false;
+    }
+
+    // Все таблицы должны целиком лежать внутри образа
+    const qint64 offsetsEnd = qint64(header->offsetsOffset) + (qint64(header->wordCount) + 1) * sizeof(quint32);
+    const qint64 ranksEnd = qint64(header->ranksOffset) + qint64(header->wordCount) * sizeof(quint32);
+    const qint64 blobEnd = qint64(header->blobOffset) + header->blobSize;
+    const qint64 nameEnd = qint64(header->nameOffset) + header->nameSize;
+    if (offsetsEnd > size || ranksEnd > size || blobEnd > size || nameEnd > size) {
+        return false;
+    }
+
+    const auto *offsets = reinterpret_cast<const quint32 *>(data + header->offsetsOffset);
+    if (offsets[header->wordCount] > header->blobSize) {
+        return false;
+    }
+
+    data_ = data;
+    size_ = size;
+    header_ = header;
+    offsets_ = offsets;
+    ranks_ = reinterpret_cast<const quint32 *>(data + header->ranksOffset);
+    blob_ = reinterpret_cast<const char *>(data + header->blobOffset);
+    return true;
+}
+
+QString WordPack::name() const {
+    if (!isOpen()) {
+        return QString();
+    }
+    return QString::fromUtf8(reinterpret_cast<const char *>(data_ + header_->nameOffset), header_->nameSize);
+}
+
+QByteArrayView WordPack::wordUtf8(int index) const {
+    return QByteArrayView(blob_ + offsets_[index], offsets_[index + 1] - offsets_[index]);
+}
+
+void WordPack::appendWord(int index, QString &text) const {
+    const QByteArrayView utf8 = wordUtf8(index);
+    const qsizetype size = text.size();
+    // В UTF-16 слово занимает не больше единиц, чем байтов в UTF-8
+    text.resize(size + utf8.size());
+    QStringDecoder decoder(QStringDecoder::Utf8);
+    const QChar *end = decoder.appendToBuffer(text.data() + size, utf8);
+    text.truncate(end - text.constData());
+}
+
+qint64 WordPack::heapBytes() const {
+    return mapped_ ? 0 : image_.capacity();
+}
+
+qint64 WordPack::stringListBytes() const {
+    if (!isOpen()) {
+        return 0;
+    }
+    // Каждое слово в QStringList — QString в списке, заголовок данных и UTF-16 с нулем;
+    // UTF-16 единиц не больше, чем байтов UTF-8, поэтому оценка сверху
+    const qint64 count = header_->wordCount;
+    return count * (qint64(sizeof(QString)) + kStringHeaderBytes) + 2 * (qint64(header_->blobSize) + count);
+}
+
+QByteArray WordPack::compileJson(const QByteArray &json, QString *error) {
+    QJsonParseError parseError;
+    const QJsonDocument doc = QJsonDocument::fromJson(json, &parseError);
+    if (parseError.error != QJsonParseError::NoError) {
+        *error = parseError.errorString();
+        return QByteArray();
+    }
+
+    const QJsonObject obj = doc.isObject() ? doc.object() : QJsonObject();
+    quint32 flags = 0;
+    if (obj.value("orderedByFrequency").toBool()) {
+        flags |= kOrderedByFrequency;
+    }
+    if (obj.value("noLazyMode").toBool()) {
+        flags |= kNoLazyMode;
+    }
+    const QByteArray name = obj.value("name").toString().toUtf8();
+
+    QByteArray blob;
+    QVector<quint32> offsets;
+    quint32 maxWordLength = 0;
+    ForEachWord(doc, [&](const QString &word) {
+        offsets.append(quint32(blob.size()));
+        blob.append(word.toUtf8());
+        maxWordLength = qMax(maxWordLength, quint32(word.length()));
+    });
+    if (offsets.isEmpty()) {
+        *error = "В файле нет слов для генерации";
+        return QByteArray();
+    }
+    const int wordCount = offsets.size();
+    offsets.append(quint32(blob.size()));
+
+    // Образ собирается в один заранее выделенный буфер
+    QByteArray image(sizeof(WordPackHeader), '\0');
+    image.reserve(sizeof(WordPackHeader) + name.size() + kAlignment
+                  + (2 * qsizetype(wordCount) + 1) * sizeof(quint32) + blob.size());
+    WordPackHeader header {};
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.flags = flags;
+    header.wordCount = quint32(wordCount);
+    header.maxWordLength = maxWordLength;
+
+    header.nameOffset = quint32(image.size());
+    header.nameSize = quint32(name.size());
+    image.append(name);
+    AlignTo(image, kAlignment);
+
+    header.offsetsOffset = quint32(image.size());
+    for (quint32 offset : offsets) {
+        AppendU32(image, offset);
+    }
+
+    // Наборы, упорядоченные по частоте, получают ранг по позиции; остальные — равные ранги
+    header.ranksOffset = quint32(image.size());
+    for (int i = 0; i < wordCount; ++i) {
+        AppendU32(image, (flags & kOrderedByFrequency) ? quint32(i) : 0);
+    }
+
+    header.blobOffset = quint32(image.size());
+    header.blobSize = quint32(blob.size());
+    image.append(blob);
+
+    std::memcpy(image.data(), &header, sizeof(header));
+    return image;
+}
@@ -0,0 +1,95 @@
+#ifndef WORDPACK_H
+#define WORDPACK_H
+
+#include <QByteArray>
+#include <QByteArrayView>
+#include <QFile>
+#include <QString>
+#include <QStringDecoder>
+
+// Скомпилированный набор слов (.kwp). Формат (little-endian):
+//   заголовок WordPackHeader,
+//   имя набора (UTF-8),
+//   таблица смещений quint32[wordCount + 1] внутри блока строк,
+//   частотные ранги quint32[wordCount],
+//   блок строк — слова в UTF-8 подряд, без разделителей.
+// Файл отображается в память и читается на месте, без разбора и выделений на слово.
+struct WordPackHeader {
+    char magic[4];
+    quint32 version;
+    quint32 flags;
+    quint32 wordCount;
+    quint32 maxWordLength;
+    quint32 nameOffset;
+    quint32 nameSize;
+    quint32 offsetsOffset;
+    quint32 ranksOffset;
+    quint32 blobOffset;
+    quint32 blobSize;
+    quint32 reserved;
+};
+
+class WordPack {
+public:
+    static constexpr char kMagic[4] = {'K', 'T', 'W', 'P'};
+    static constexpr quint32 kVersion = 1;
+    static constexpr quint32 kOrderedByFrequency = 1u << 0;
+    static constexpr quint32 kNoLazyMode = 1u << 1;
+    // Заголовок QArrayData с выравниванием, как у строк Qt 6 на 64-битных платформах
+    static constexpr qint64 kStringHeaderBytes = 32;
+
+    WordPack() = default;
+    ~WordPack();
+    WordPack(const WordPack &) = delete;
+    WordPack &operator=(const WordPack &) = delete;
+
+    // Отображает .kwp в память
+    bool open(const QString &path);
+    // Использует уже собранный образ (например, из compileJson)
+    bool openData(const QByteArray &image);
+    void close();
+
+    // Набор с диска: .kwp отображается в память, JSON собирается в образ
+    bool openFile(const QString &path, QString *error);
+
+    // Собирает образ .kwp из JSON-набора слов (массив, {"words": [...]} или объект строк)
+    static QByteArray compileJson(const QByteArray &json, QString *error);
+
+    bool isOpen() const { return header_ != nullptr; }
+    int count() const { return isOpen() ? int(header_->wordCount) : 0; }
+    bool isEmpty() const { return count() == 0; }
+    QString name() const;
+    int maxWordLength() const { return isOpen() ? int(header_->maxWordLength) : 0; }
+    bool orderedByFrequency() const { return isOpen() && (header_->flags & kOrderedByFrequency); }
+    bool noLazyMode() const { return isOpen() && (header_->flags & kNoLazyMode); }
+
+    QByteArrayView wordUtf8(int index) const;
+    QString word(int index) const { return QString::fromUtf8(wordUtf8(index)); }
+    // Дописывает слово в конец text без промежуточных строк; при достаточной емкости не выделяет память
+    void appendWord(int index, QString &text) const;
+    quint32 rank(int index) const { return ranks_[index]; }
+
+    // Размер образа: для отображенного файла это адресное пространство, а не куча
+    qint64 imageSize() const { return size_; }
+    bool isMapped() const { return mapped_; }
+    // Занято в куче: ноль для отображенного файла, размер образа для собранного из JSON
+    qint64 heapBytes() const;
+    // Оценка того, сколько занял бы тот же набор в виде QStringList
+    qint64 stringListBytes() const;
+
+private:
+    bool attach(const uchar *data, qint64 size);
+
+    QFile file_;
+    QByteArray image_;
+    const uchar *data_ = nullptr;
+    qint64 size_ = 0;
+    bool mapped_ = false;
+
+    const WordPackHeader *header_ = nullptr;
+    const quint32 *offsets_ = nullptr;
+    const quint32 *ranks_ = nullptr;
+    const char *blob_ = nullptr;
+};
+
+#endif // WORDPACK_H
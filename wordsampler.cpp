@@ -0,0 +1,59 @@
+#include "wordsampler.h"
+
+void WordSampler::build(const WordPack &words) {
+    clear();
+    const int n = words.count();
+    if (n == 0) {
+        return;
+    }
+
+    QVector<double> scaled(n);
+    double total = 0;
+    for (int i = 0; i < n; ++i) {
+        scaled[i] = 1.0 / (double(words.rank(i)) + 1.0);
+        total += scaled[i];
+    }
+    for (double &p : scaled) {
+        p *= n / total;
+    }
+
+    // Алгоритм Воуза: недобравшие столбцы дополняются из переполненных
+    QVector<int> small;
+    QVector<int> large;
+    small.reserve(n);
+    large.reserve(n);
+    for (int i = 0; i < n; ++i) {
+        (scaled[i] < 1.0 ? small : large).append(i);
+    }
+
+    threshold_.resize(n);
+    alias_.resize(n);
+    constexpr double kScale = 4294967296.0;
+    while (!small.isEmpty() && !large.isEmpty()) {
+        const int less = small.takeLast();
+        const int more = large.last();
+        threshold_[less] = quint32(scaled[less] * kScale);
+        alias_[less] = more;
+
+        scaled[more] -= 1.0 - scaled[less];
+        if (scaled[more] < 1.0) {
+            large.removeLast();
+            small.append(more);
+        }
+    }
+
+    // Остатки из-за округления получают вероятность 1
+    for (int i : large) {
+        threshold_[i] = 0xFFFFFFFFu;
+        alias_[i] = i;
+    }
+    for (int i : small) {
+        threshold_[i] = 0xFFFFFFFFu;
+        alias_[i] = i;
+    }
+}
+
+void WordSampler::clear() {
+    threshold_.clear();
+    alias_.clear();
+}
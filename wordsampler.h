@@ -0,0 +1,32 @@
+#ifndef WORDSAMPLER_H
+#define WORDSAMPLER_H
+
+#include <QRandomGenerator>
+#include <QVector>
+#include "wordpack.h"
+
+// Выборка слов с частотой по закону Ципфа: вес слова 1 / (ранг + 1).
+// Таблица псевдонимов Уолкера строится за O(n) один раз на набор,
+// каждое слово затем достается за O(1) — одно обращение к генератору.
+class WordSampler {
+public:
+    void build(const WordPack &words);
+    void clear();
+
+    bool isEmpty() const { return threshold_.isEmpty(); }
+    int size() const { return threshold_.size(); }
+
+    int draw(QRandomGenerator &rng) const {
+        const quint64 bits = rng.generate64();
+        // Старшие 32 бита выбирают столбец, младшие — сторону внутри него
+        const int column = int(((bits >> 32) * quint64(threshold_.size())) >> 32);
+        return quint32(bits) < threshold_[column] ? column : alias_[column];
+    }
+
+private:
+    // Вероятность остаться в столбце, масштабированная на 2^32
+    QVector<quint32> threshold_;
+    QVector<int> alias_;
+};
+
+#endif // WORDSAMPLER_H
@@ -0,0 +1,192 @@
+#include "wordsearchindex.h"
+#include "wordpack.h"
+#include <QFileInfo>
+#include <QtAlgorithms>
+#include <algorithm>
+#include <utility>
+
+namespace {
+
+void AppendVarint(QByteArray &out, quint32 value) {
+    while (value >= 0x80) {
+        out.append(char((value & 0x7F) | 0x80));
+        value >>= 7;
+    }
+    out.append(char(value));
+}
+
+quint32 ReadVarint(const char *&p) {
+    quint32 value = 0;
+    int shift = 0;
+    uchar byte;
+    do {
+        byte = uchar(*p++);
+        value |= quint32(byte & 0x7F) << shift;
+        shift += 7;
+    } while (byte & 0x80);
+    return value;
+}
+
+} // namespace
+
+QSharedPointer<const WordSearchIndex> WordSearchIndex::build(const QStringList &paths) {
+    auto index = QSharedPointer<WordSearchIndex>::create();
+
+    QVector<std::pair<QByteArray, int>> entries;
+    for (int set = 0; set < paths.size(); ++set) {
+        index->setNames_.append(QFileInfo(paths.at(set)).completeBaseName());
+        WordPack words;
+        QString error;
+        if (!words.openFile(paths.at(set), &error)) {
+            continue;
+        }
+        for (int i = 0; i < words.count(); ++i) {
+            entries.append({ words.word(i).toLower().toUtf8(), set });
+        }
+    }
+    std::sort(entries.begin(), entries.end());
+    entries.erase(std::unique(entries.begin(), entries.end()), entries.end());
+
+    index->maskWords_ = (index->setNames_.size() + 63) / 64;
+    QByteArray previous;
+    for (int i = 0; i < entries.size(); ++i) {
+        const QByteArray &word = entries.at(i).first;
+        const int set = entries.at(i).second;
+        int shared = 0;
+        if (i % kBlockSize == 0) {
+            index->blockOffsets_.append(quint32(index->blob_.size()));
+            index->blockSets_.resize(index->blockSets_.size() + index->maskWords_);
+        } else {
+            const int limit = qMin(word.size(), previous.size());
+            while (shared < limit && word.at(shared) == previous.at(shared)) {
+                ++shared;
+            }
+        }
+        AppendVarint(index->blob_, quint32(shared));
+        AppendVarint(index->blob_, quint32(word.size() - shared));
+        index->blob_.append(word.constData() + shared, word.size() - shared);
+        AppendVarint(index->blob_, quint32(set));
+        index->blockSets_[index->blockSets_.size() - index->maskWords_ + set / 64] |= quint64(1) << (set % 64);
+        previous = word;
+    }
+
+    index->entryCount_ = entries.size();
+    index->blob_.squeeze();
+    index->blockOffsets_.squeeze();
+    index->blockSets_.squeeze();
+    return index;
+}
+
+QByteArrayView WordSearchIndex::blockHead(int block) const {
+    // У первого слова блока общий префикс нулевой, поэтому оно лежит в blob_ целиком
+    const char *p = blob_.constData() + blockOffsets_[block];
+    ReadVarint(p);
+    const quint32 length = ReadVarint(p);
+    return QByteArrayView(p, length);
+}
+
+int WordSearchIndex::firstBlockFor(QByteArrayView needle) const {
+    // Последний блок, первое слово которого меньше префикса: совпадения начинаются в нем или позже
+    int lo = 0;
+    int hi = blockOffsets_.size();
+    while (lo < hi) {
+        const int mid = (lo + hi) / 2;
+        if (blockHead(mid) < needle) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return qMax(0, lo - 1);
+}
+
+QVector<WordSearchHit> WordSearchIndex::search(const QString &prefix, int limit) const {
+    QVector<WordSearchHit> hits;
+    const QByteArray needle = prefix.toLower().toUtf8();
+    if (needle.isEmpty() || blockOffsets_.isEmpty()) {
+        return hits;
+    }
+
+    QByteArray word;
+    QByteArray lastHit;
+    const char *p = blob_.constData() + blockOffsets_[firstBlockFor(needle)];
+    const char *end = blob_.constData() + blob_.size();
+    while (p < end) {
+        const quint32 shared = ReadVarint(p);
+        const quint32 suffix = ReadVarint(p);
+        word.truncate(shared);
+        word.append(p, suffix);
+        p += suffix;
+        const int set = int(ReadVarint(p));
+
+        if (word.startsWith(needle)) {
+            if (hits.isEmpty() || word != lastHit) {
+                if (hits.size() == limit) {
+                    break;
+                }
+                lastHit = word;
+                hits.append({ QString::fromUtf8(word), {} });
+            }
+            hits.last().sets.append(set);
+        } else if (QByteArrayView(word) > QByteArrayView(needle)) {
+            break;
+        }
+    }
+    return hits;
+}
+
+QVector<int> WordSearchIndex::setsWithPrefix(const QString &prefix) const {
+    QVector<int> sets;
+    const QByteArray needle = prefix.toLower().toUtf8();
+    if (needle.isEmpty() || blockOffsets_.isEmpty()) {
+        return sets;
+    }
+
+    // Только номера наборов: слова не превращаются в строки и не копятся
+    QVector<quint64> seen(maskWords_, 0);
+    auto mark = [&](int set) {
+        quint64 &bits = seen[set / 64];
+        const quint64 bit = quint64(1) << (set % 64);
+        if (!(bits & bit)) {
+            bits |= bit;
+            sets.append(set);
+        }
+    };
+
+    const int blocks = blockOffsets_.size();
+    QByteArray word;
+    for (int block = firstBlockFor(needle); block < blocks && sets.size() < setNames_.size(); ++block) {
+        // Первые слова этого и следующего блоков начинаются с префикса — значит, и все
+        // слова между ними: наборы берутся из маски блока
+        if (block + 1 < blocks && blockHead(block).startsWith(needle) && blockHead(block + 1).startsWith(needle)) {
+            const quint64 *mask = blockSets_.constData() + qsizetype(block) * maskWords_;
+            for (int i = 0; i < maskWords_; ++i) {
+                quint64 fresh = mask[i] & ~seen[i];
+                while (fresh != 0) {
+                    mark(i * 64 + qCountTrailingZeroBits(fresh));
+                    fresh &= fresh - 1;
+                }
+            }
+            continue;
+        }
+
+        // Граница диапазона: блок разбирается по словам
+        const char *p = blob_.constData() + blockOffsets_[block];
+        const char *end = blob_.constData() + (block + 1 < blocks ? blockOffsets_[block + 1] : blob_.size());
+        while (p < end) {
+            const quint32 shared = ReadVarint(p);
+            const quint32 suffix = ReadVarint(p);
+            word.truncate(shared);
+            word.append(p, suffix);
+            p += suffix;
+            const int set = int(ReadVarint(p));
+
+            if (word.startsWith(needle)) {
+                mark(set);
+            } else if (QByteArrayView(word) > QByteArrayView(needle)) {
+                return sets;
+            }
+        }
+    }
+    return sets;
+}
@@ -0,0 +1,54 @@
+#ifndef WORDSEARCHINDEX_H
+#define WORDSEARCHINDEX_H
+
+#include <QByteArray>
+#include <QSharedPointer>
+#include <QStringList>
+#include <QVector>
+
+struct WordSearchHit {
+    QString word;
+    // Номера наборов в setNames()
+    QVector<int> sets;
+};
+
+// Общий индекс слов всех наборов для поиска по префиксу.
+// Пары (слово в нижнем регистре, набор) отсортированы и хранятся с фронтальным
+// кодированием блоками по kBlockSize: первое слово блока записано целиком,
+// у остальных — длина общего с предыдущим префикса и хвост. Поиск — бинарный
+// по первым словам блоков и последовательное чтение нескольких блоков.
+class WordSearchIndex {
+public:
+    static constexpr int kBlockSize = 16;
+
+    // Строится в фоне из наборов .kwp или JSON
+    static QSharedPointer<const WordSearchIndex> build(const QStringList &paths);
+
+    // До limit различных слов, начинающихся с prefix (без учета регистра)
+    QVector<WordSearchHit> search(const QString &prefix, int limit) const;
+    // Все наборы, где есть слово с началом prefix, без ограничения числа слов
+    QVector<int> setsWithPrefix(const QString &prefix) const;
+
+    const QStringList &setNames() const { return setNames_; }
+    int entryCount() const { return entryCount_; }
+    qint64 memoryBytes() const {
+        return blob_.capacity() + blockOffsets_.capacity() * qint64(sizeof(quint32))
+            + blockSets_.capacity() * qint64(sizeof(quint64));
+    }
+
+private:
+    QByteArrayView blockHead(int block) const;
+    // Первый блок, в котором могут начинаться слова с префиксом needle
+    int firstBlockFor(QByteArrayView needle) const;
+
+    QStringList setNames_;
+    QByteArray blob_;
+    QVector<quint32> blockOffsets_;
+    // Битовая маска наборов каждого блока по maskWords_ слов: блок, целиком лежащий
+    // внутри диапазона префикса, отвечает в setsWithPrefix без разбора его слов
+    QVector<quint64> blockSets_;
+    int maskWords_ = 0;
+    int entryCount_ = 0;
+};
+
+#endif // WORDSEARCHINDEX_H
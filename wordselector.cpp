@@ -0,0 +1,91 @@
+#include "wordselector.h"
+#include <numeric>
+
+QString WordSelector::reserveText(const WordPack &words, int count) {
+    // appendWord временно расширяет строку на длину слова в UTF-8 (до трех байт на единицу UTF-16)
+    QString text;
+    text.reserve(qsizetype(count) * (words.maxWordLength() + 1) + 3 * words.maxWordLength());
+    return text;
+}
+
+QString WordSelector::selectUniform(const WordPack &words, int count, QRandomGenerator &rng) {
+    const int n = words.count();
+    count = qMin(count, n);
+    if (count <= 0) {
+        return QString();
+    }
+
+    if (indices_.size() != n) {
+        indices_.resize(n);
+        std::iota(indices_.begin(), indices_.end(), 0);
+    }
+    swaps_.resize(count);
+
+    QString text = reserveText(words, count);
+    for (int i = 0; i < count; ++i) {
+        const int j = i + int(rng.bounded(quint32(n - i)));
+        std::swap(indices_[i], indices_[j]);
+        swaps_[i] = j;
+
+        if (i > 0) {
+            text += ' ';
+        }
+        words.appendWord(indices_[i], text);
+    }
+
+    // Возвращаем тождественную перестановку для следующего вызова
+    for (int i = count - 1; i >= 0; --i) {
+        std::swap(indices_[i], indices_[swaps_[i]]);
+    }
+    return text;
+}
+
+QString WordSelector::selectWeighted(const WordPack &words, const WordSampler &sampler, int count, QRandomGenerator &rng) {
+    if (count <= 0 || sampler.isEmpty()) {
+        return QString();
+    }
+
+    QString text = reserveText(words, count);
+    for (int i = 0; i < count; ++i) {
+        if (i > 0) {
+            text += ' ';
+        }
+        words.appendWord(sampler.draw(rng), text);
+    }
+    return text;
+}
+
+QString WordSelector::selectTargeted(const WordPack &words, const NgramIndex &index,
+                                     const QVector<NgramWeight> &targets, int count, QRandomGenerator &rng) {
+    targetPostings_.clear();
+    targetCumulative_.clear();
+    double total = 0;
+    for (const NgramWeight &target : targets) {
+        const NgramIndex::Postings postings = index.find(target.key);
+        if (postings.size() > 0 && target.weight > 0) {
+            total += target.weight;
+            targetPostings_.append(postings);
+            targetCumulative_.append(total);
+        }
+    }
+    if (count <= 0 || targetPostings_.isEmpty()) {
+        return QString();
+    }
+
+    QString text = reserveText(words, count);
+    for (int i = 0; i < count; ++i) {
+        // Слабых мест немного, поэтому линейный проход по накопленным весам дешевле дерева
+        const double u = rng.generateDouble() * total;
+        int slot = 0;
+        while (slot + 1 < targetCumulative_.size() && targetCumulative_[slot] <= u) {
+            ++slot;
+        }
+        const NgramIndex::Postings &postings = targetPostings_[slot];
+
+        if (i > 0) {
+            text += ' ';
+        }
+        words.appendWord(int(postings.begin[rng.bounded(quint32(postings.size()))]), text);
+    }
+    return text;
+}
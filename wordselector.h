@@ -0,0 +1,36 @@
+#ifndef WORDSELECTOR_H
+#define WORDSELECTOR_H
+
+#include <QRandomGenerator>
+#include <QString>
+#include <QVector>
+#include "ngramindex.h"
+#include "wordpack.h"
+#include "wordsampler.h"
+
+// Собирает текст из слов набора в один заранее зарезервированный QString.
+// Различные слова выбираются частичным перемешиванием Фишера — Йетса по
+// переиспользуемому буферу индексов: перестановки после выборки откатываются,
+// поэтому каждый вызов стоит O(count) независимо от размера набора.
+class WordSelector {
+public:
+    // count различных слов (не больше размера набора) через пробел
+    QString selectUniform(const WordPack &words, int count, QRandomGenerator &rng);
+    // count слов по частотам sampler; повторы допускаются
+    QString selectWeighted(const WordPack &words, const WordSampler &sampler, int count, QRandomGenerator &rng);
+
+    // count слов, содержащих символы и биграммы targets; ключ выбирается пропорционально
+    // весу, слово — равновероятно из его списка в index. Пусто, если ни одного ключа нет в наборе
+    QString selectTargeted(const WordPack &words, const NgramIndex &index,
+                           const QVector<NgramWeight> &targets, int count, QRandomGenerator &rng);
+
+private:
+    static QString reserveText(const WordPack &words, int count);
+
+    QVector<int> indices_;
+    QVector<int> swaps_;
+    QVector<NgramIndex::Postings> targetPostings_;
+    QVector<double> targetCumulative_;
+};
+
+#endif // WORDSELECTOR_H
@@ -0,0 +1,264 @@
+#include "wordsetcatalog.h"
+#include "wordpack.h"
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFile>
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QRegularExpression>
+#include <QSaveFile>
+#include <QtConcurrent/QtConcurrentRun>
+#include <algorithm>
+
+namespace {
+constexpr int kManifestVersion = 1;
+// Письменность определяется по первым буквам начала списка
+constexpr int kScriptSampleWords = 200;
+
+QString ScriptName(QChar::Script script) {
+    switch (script) {
+    case QChar::Script_Latin: return "Latin";
+    case QChar::Script_Cyrillic: return "Cyrillic";
+    case QChar::Script_Greek: return "Greek";
+    case QChar::Script_Armenian: return "Armenian";
+    case QChar::Script_Georgian: return "Georgian";
+    case QChar::Script_Hebrew: return "Hebrew";
+    case QChar::Script_Arabic: return "Arabic";
+    case QChar::Script_Devanagari: return "Devanagari";
+    case QChar::Script_Bengali: return "Bengali";
+    case QChar::Script_Tamil: return "Tamil";
+    case QChar::Script_Thai: return "Thai";
+    case QChar::Script_Hangul: return "Hangul";
+    case QChar::Script_Hiragana:
+    case QChar::Script_Katakana: return "Kana";
+    case QChar::Script_Han: return "Han";
+    default: return "Other";
+    }
+}
+
+QString DetectScript(const WordPack &words) {
+    QHash<QString, int> votes;
+    const int sample = qMin(words.count(), kScriptSampleWords);
+    for (int i = 0; i < sample; ++i) {
+        const QString word = words.word(i);
+        for (auto it = word.cbegin(); it != word.cend(); ++it) {
+            const char32_t ucs = it->isHighSurrogate() && it + 1 != word.cend()
+                ? QChar::surrogateToUcs4(*it, *(it + 1)) : it->unicode();
+            if (QChar::isLetter(ucs)) {
+                ++votes[ScriptName(QChar::script(ucs))];
+                break;
+            }
+        }
+    }
+
+    QString best = "Other";
+    int bestVotes = 0;
+    for (auto it = votes.cbegin(); it != votes.cend(); ++it) {
+        if (it.value() > bestVotes) {
+            best = it.key();
+            bestVotes = it.value();
+        }
+    }
+    return best;
+}
+
+QJsonObject ToJson(const WordSetInfo &info) {
+    return QJsonObject {
+        { "file", info.fileName },
+        { "name", info.name },
+        { "language", info.language },
+        { "sizeClass", info.sizeClass },
+        { "wordCount", info.wordCount },
+        { "maxWordLength", info.maxWordLength },
+        { "script", info.script },
+        { "checksum", info.checksum },
+        { "fileSize", info.fileSize },
+        { "modified", info.modifiedMs },
+    };
+}
+
+WordSetInfo FromJson(const QJsonObject &obj) {
+    WordSetInfo info;
+    info.fileName = obj.value("file").toString();
+    info.name = obj.value("name").toString();
+    info.language = obj.value("language").toString();
+    info.sizeClass = obj.value("sizeClass").toInt();
+    info.wordCount = obj.value("wordCount").toInt();
+    info.maxWordLength = obj.value("maxWordLength").toInt();
+    info.script = obj.value("script").toString();
+    info.checksum = obj.value("checksum").toString();
+    info.fileSize = obj.value("fileSize").toInteger();
+    info.modifiedMs = obj.value("modified").toInteger();
+    return info;
+}
+}
+
+WordSetCatalog::WordSetCatalog(QObject *parent) : QObject(parent) {
+    connect(&fsWatcher_, &QFileSystemWatcher::directoryChanged, this, &WordSetCatalog::refresh);
+    connect(&watcher_, &QFutureWatcher<QVector<WordSetInfo>>::finished, this, &WordSetCatalog::onScanFinished);
+}
+
+WordSetCatalog::~WordSetCatalog() {
+    watcher_.waitForFinished();
+}
+
+void WordSetCatalog::open(const QString &directory, const QString &manifestPath) {
+    if (!fsWatcher_.directories().isEmpty()) {
+        fsWatcher_.removePaths(fsWatcher_.directories());
+    }
+    directory_ = directory;
+    manifestPath_ = manifestPath;
+
+    // Манифест из прошлого запуска показывается сразу, сверка с папкой идет в фоне
+    if (loadManifest()) {
+        emit changed();
+    }
+    // Встроенные ресурсы неизменны, следить нужно только за папкой на диске
+    if (!directory_.startsWith(':')) {
+        fsWatcher_.addPath(directory_);
+    }
+    refresh();
+}
+
+QStringList WordSetCatalog::languages() const {
+    QStringList result;
+    for (const WordSetInfo &info : entries_) {
+        if (!result.contains(info.language)) {
+            result.append(info.language);
+        }
+    }
+    result.sort(Qt::CaseInsensitive);
+    return result;
+}
+
+void WordSetCatalog::refresh() {
+    if (watcher_.isRunning()) {
+        refreshQueued_ = true;
+        return;
+    }
+
+    QHash<QString, WordSetInfo> known;
+    for (const WordSetInfo &info : entries_) {
+        known.insert(info.fileName, info);
+    }
+
+    const QFileInfoList files = QDir(directory_).entryInfoList({"*.json", "*.kwp"}, QDir::Files | QDir::NoSymLinks);
+    QVector<WordSetInfo> unchanged;
+    QFileInfoList stale;
+    for (const QFileInfo &file : files) {
+        const auto it = known.constFind(file.fileName());
+        if (it != known.cend() && it->fileSize == file.size()
+            && it->modifiedMs == file.lastModified().toMSecsSinceEpoch()) {
+            unchanged.append(*it);
+        } else {
+            stale.append(file);
+        }
+    }
+
+    // Только удаления — разбирать нечего
+    if (stale.isEmpty()) {
+        if (unchanged.size() != entries_.size()) {
+            entries_ = unchanged;
+            saveManifest();
+            emit changed();
+        }
+        return;
+    }
+
+    watcher_.setFuture(QtConcurrent::run([unchanged, stale]() {
+        QVector<WordSetInfo> result = unchanged;
+        for (const QFileInfo &file : stale) {
+            const WordSetInfo info = scanFile(file);
+            if (info.wordCount > 0) {
+                result.append(info);
+            }
+        }
+        std::sort(result.begin(), result.end(), [](const WordSetInfo &a, const WordSetInfo &b) {
+            return a.fileName < b.fileName;
+        });
+        return result;
+    }));
+}
+
+void WordSetCatalog::onScanFinished() {
+    entries_ = watcher_.result();
+    saveManifest();
+    emit changed();
+
+    if (refreshQueued_) {
+        refreshQueued_ = false;
+        refresh();
+    }
+}
+
+WordSetInfo WordSetCatalog::scanFile(const QFileInfo &file) {
+    WordSetInfo info;
+    info.fileName = file.fileName();
+    info.fileSize = file.size();
+    info.modifiedMs = file.lastModified().toMSecsSinceEpoch();
+
+    // Поля каталога берутся из заголовка и начала набора: .kwp отображается
+    // в память без распаковки, JSON собирается в образ
+    QString error;
+    WordPack words;
+    if (!words.openFile(file.filePath(), &error)) {
+        return info;
+    }
+    QFile input(file.filePath());
+    if (input.open(QIODevice::ReadOnly)) {
+        QCryptographicHash hash(QCryptographicHash::Sha1);
+        hash.addData(&input);
+        info.checksum = QString::fromLatin1(hash.result().toHex());
+    }
+
+    // Имя файла вида russian_50k: язык и размер набора
+    static const QRegularExpression sizeSuffix("^(.*)_(\\d+)k$");
+    const QString baseName = file.completeBaseName();
+    const QRegularExpressionMatch match = sizeSuffix.match(baseName);
+    info.language = match.hasMatch() ? match.captured(1) : baseName;
+    info.sizeClass = match.hasMatch() ? match.captured(2).toInt() * 1000 : 0;
+    info.name = words.name().isEmpty() ? baseName : words.name();
+    info.wordCount = words.count();
+    info.maxWordLength = words.maxWordLength();
+    info.script = DetectScript(words);
+    return info;
+}
+
+bool WordSetCatalog::loadManifest() {
+    QFile file(manifestPath_);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    const QJsonObject root = QJsonDocument::fromJson(file.readAll()).object();
+    if (root.value("version").toInt() != kManifestVersion || root.value("directory").toString() != directory_) {
+        return false;
+    }
+
+    entries_.clear();
+    for (const QJsonValue &val : root.value("sets").toArray()) {
+        entries_.append(FromJson(val.toObject()));
+    }
+    return true;
+}
+
+bool WordSetCatalog::saveManifest() const {
+    QJsonArray sets;
+    for (const WordSetInfo &info : entries_) {
+        sets.append(ToJson(info));
+    }
+    const QJsonObject root {
+        { "version", kManifestVersion },
+        { "directory", directory_ },
+        { "sets", sets },
+    };
+
+    QSaveFile file(manifestPath_);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+    file.write(QJsonDocument(root).toJson(QJsonDocument::Indented));
+    return file.commit();
+}
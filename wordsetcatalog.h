@@ -0,0 +1,60 @@
+#ifndef WORDSETCATALOG_H
+#define WORDSETCATALOG_H
+
+#include <QFileInfo>
+#include <QFileSystemWatcher>
+#include <QFutureWatcher>
+#include <QObject>
+#include <QVector>
+
+struct WordSetInfo {
+    QString fileName;
+    QString name;
+    QString language;
+    // Размер по суффиксу имени (english_10k -> 10000); 0 — базовый набор
+    int sizeClass = 0;
+    int wordCount = 0;
+    int maxWordLength = 0;
+    QString script;
+    QString checksum;
+    qint64 fileSize = 0;
+    qint64 modifiedMs = 0;
+};
+
+// Каталог наборов слов. Хранится в JSON-манифесте и при запуске сверяется с папкой
+// по размеру и времени изменения: разбираются только новые и измененные файлы.
+// Дальше папка отслеживается QFileSystemWatcher, и диалогу выбора не нужно
+// трогать сами файлы.
+class WordSetCatalog : public QObject {
+    Q_OBJECT
+
+public:
+    explicit WordSetCatalog(QObject *parent = nullptr);
+    ~WordSetCatalog() override;
+
+    void open(const QString &directory, const QString &manifestPath);
+
+    QString directory() const { return directory_; }
+    const QVector<WordSetInfo> &entries() const { return entries_; }
+    QStringList languages() const;
+    bool isScanning() const { return watcher_.isRunning(); }
+
+signals:
+    void changed();
+
+private:
+    void refresh();
+    void onScanFinished();
+    bool loadManifest();
+    bool saveManifest() const;
+    static WordSetInfo scanFile(const QFileInfo &file);
+
+    QString directory_;
+    QString manifestPath_;
+    QVector<WordSetInfo> entries_;
+    QFileSystemWatcher fsWatcher_;
+    QFutureWatcher<QVector<WordSetInfo>> watcher_;
+    bool refreshQueued_ = false;
+};
+
+#endif // WORDSETCATALOG_H